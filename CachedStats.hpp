@@ -0,0 +1,88 @@
+#pragma once
+
+// RunningStats with its Summary() kept between changes and a counter of
+// those changes, for consumers which read the same statistics often or
+// want to skip shards that did not move since they last looked
+//
+// CachedStats shard;
+// shard.Push(x);
+// const RunningStatsSummary &s = shard.Summary();  // computed once per change
+// if (shard.Generation() != seen) { total += shard.Stats(); seen = shard.Generation(); }
+//
+// the cache lives here rather than in RunningStats so the plain accumulator
+// keeps its size in per-key and per-thread arrays. Summary() fills the cache
+// and is therefore not const: concurrent readers should take a SeqlockStats
+// snapshot and call RunningStats::Summary() on it instead.
+//
+// Generation() counts the changes of this object: it starts at 0 and goes up
+// by one with every Push, Clear and merge, so it never repeats. Generations of
+// different objects are not comparable, and a merge does not carry over the
+// generation of either side.
+
+#include <stdint.h>
+
+#include "RunningStats.hpp"
+
+class CachedStats {
+  public:
+    CachedStats() : _gen(0), _cached(false) {}
+
+    void Clear() {
+        _rs.Clear();
+        Changed();
+    }
+
+    void Push(_float_t x) {
+        _rs.Push(x);
+        Changed();
+    }
+
+    /**
+     * @brief Merge another accumulator into this one
+     */
+    CachedStats &operator+=(const RunningStats &rhs) {
+        _rs += rhs;
+        Changed();
+        return *this;
+    }
+
+    CachedStats &operator+=(const CachedStats &rhs) {
+        return *this += rhs._rs;
+    }
+
+    /**
+     * @brief The derived statistics, computed on the first call after a change
+     */
+    const RunningStatsSummary &Summary() {
+        if (!_cached) {
+            _summary = _rs.Summary();
+            _cached = true;
+        }
+        return _summary;
+    }
+
+    /**
+     * @brief Number of changes to this object so far
+     */
+    uint64_t Generation() const {
+        return _gen;
+    }
+
+    /**
+     * @brief The underlying accumulator, e.g. to merge or for single statistics
+     */
+    const RunningStats &Stats() const {
+        return _rs;
+    }
+
+  private:
+    void Changed() {
+        _gen++;
+        _cached = false;
+    }
+
+    RunningStats _rs;
+    RunningStatsSummary _summary;
+    uint64_t _gen;
+    bool _cached;
+};
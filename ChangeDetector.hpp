@@ -0,0 +1,259 @@
+#pragma once
+
+// streaming change-point / anomaly detectors, O(1) per sample
+//
+// each detector's Push() returns the event for that sample directly, so faults
+// are flagged on the sample that triggers them, without a separate polling pass.
+//
+// ZScoreDetector  - |x - EW mean| > threshold * EW standard deviation
+// CusumDetector   - two-sided CUSUM against a baseline learned during warmup
+// PageHinkley     - Page-Hinkley test against the running mean
+// DetectorBank    - one detector per channel, fed a whole frame at a time
+
+#include <math.h>
+#include <vector>
+
+#include "ExponentialSmoothing.hpp"
+#include "RunningStats.hpp"
+
+typedef enum {
+    CHANGE_NONE = 0,
+    CHANGE_UP,
+    CHANGE_DOWN,
+} change_t;
+
+class ZScoreDetector {
+  public:
+    /**
+     * @param alpha Smoothing factor of the EW mean and variance (0-1)
+     * @param threshold Alarm level in standard deviations
+     * @param warmup Samples used to seed mean and variance, no alarms before
+     */
+    ZScoreDetector(_float_t alpha = 0.05, _float_t threshold = 4.0, _counter_t warmup = 16)
+        : _mean(alpha), _var(alpha), _threshold(threshold), _warmup(warmup) {
+        Clear();
+    }
+
+    void Clear() {
+        _mean = ExponentialSmoothing(_mean.Alpha());
+        _var = ExponentialSmoothing(_var.Alpha());
+        _seed.Clear();
+        _z = 0;
+    }
+
+    change_t Push(_float_t x) {
+        if (_seed.NumDataValues() < _warmup) {
+            _seed.Push(x);
+            if (_seed.NumDataValues() == _warmup) {
+                _mean.Push(_seed.Mean());
+                _var.Push(_seed.PopulationVariance());
+            }
+            return CHANGE_NONE;
+        }
+        _float_t d = x - _mean.Value();
+        _float_t var = _var.Value();
+        _z = var > 0 ? d / sqrt(var) : 0;
+        _mean.Push(x);
+        _var.Push(d * d);
+        if (_z > _threshold) {
+            return CHANGE_UP;
+        }
+        if (_z < -_threshold) {
+            return CHANGE_DOWN;
+        }
+        return CHANGE_NONE;
+    }
+
+    // z-score of the last sample against the state before it
+    _float_t Score() const {
+        return _z;
+    }
+
+    _float_t Mean() {
+        return _mean.Value();
+    }
+
+    _float_t Variance() {
+        return _var.Value();
+    }
+
+  private:
+    ExponentialSmoothing _mean, _var;
+    RunningStats _seed;
+    _float_t _threshold, _z;
+    _counter_t _warmup;
+};
+
+class CusumDetector {
+  public:
+    /**
+     * @param k Slack per sample, in standard deviations of the baseline
+     * @param h Alarm level of the cumulative sums, in standard deviations
+     * @param warmup Samples used to learn the baseline mean and deviation
+     */
+    CusumDetector(_float_t k = 0.5, _float_t h = 5.0, _counter_t warmup = 32)
+        : _k(k), _h(h), _warmup(warmup) {
+        Clear();
+    }
+
+    // forget the baseline and learn it again
+    void Clear() {
+        _baseline.Clear();
+        Reset();
+    }
+
+    // restart the cumulative sums, keeping the baseline
+    void Reset() {
+        _hi = _lo = 0;
+    }
+
+    change_t Push(_float_t x) {
+        if (_baseline.NumDataValues() < _warmup) {
+            _baseline.Push(x);
+            if (_baseline.NumDataValues() == _warmup) {
+                _mean = _baseline.Mean();
+                _sd = _baseline.StandardDeviation();
+                _inv_sd = _sd > 0 ? 1 / _sd : 0;
+            }
+            return CHANGE_NONE;
+        }
+        _float_t z = (x - _mean) * _inv_sd;
+        _hi = fmax(0, _hi + z - _k);
+        _lo = fmax(0, _lo - z - _k);
+        if (_hi > _h) {
+            Reset();
+            return CHANGE_UP;
+        }
+        if (_lo > _h) {
+            Reset();
+            return CHANGE_DOWN;
+        }
+        return CHANGE_NONE;
+    }
+
+    _float_t Upper() const {
+        return _hi;
+    }
+
+    _float_t Lower() const {
+        return _lo;
+    }
+
+  private:
+    RunningStats _baseline;
+    _float_t _mean, _sd, _inv_sd;
+    _float_t _hi, _lo;
+    _float_t _k, _h;
+    _counter_t _warmup;
+};
+
+class PageHinkley {
+  public:
+    /**
+     * @param delta Magnitude of change tolerated without alarm
+     * @param lambda Alarm level of the cumulative deviation
+     * @param minSamples Samples required before an alarm is raised
+     */
+    PageHinkley(_float_t delta = 0.005, _float_t lambda = 50, _counter_t minSamples = 30)
+        : _delta(delta), _lambda(lambda), _min(minSamples) {
+        Clear();
+    }
+
+    void Clear() {
+        _stats.Clear();
+        _up = _upMin = _down = _downMin = 0;
+    }
+
+    change_t Push(_float_t x) {
+        _stats.Push(x);
+        _float_t d = x - _stats.Mean();
+        _up += d - _delta;
+        _down += -d - _delta;
+        _upMin = fmin(_upMin, _up);
+        _downMin = fmin(_downMin, _down);
+        if (_stats.NumDataValues() < _min) {
+            return CHANGE_NONE;
+        }
+        if (_up - _upMin > _lambda) {
+            Clear();
+            return CHANGE_UP;
+        }
+        if (_down - _downMin > _lambda) {
+            Clear();
+            return CHANGE_DOWN;
+        }
+        return CHANGE_NONE;
+    }
+
+    _float_t Mean() const {
+        return _stats.Mean();
+    }
+
+  private:
+    RunningStats _stats;
+    _float_t _up, _upMin, _down, _downMin;
+    _float_t _delta, _lambda;
+    _counter_t _min;
+};
+
+/**
+ * @brief Independent detectors for many channels, one frame of samples per Push
+ */
+template <typename Detector>
+class DetectorBank {
+  public:
+    /**
+     * @param channels Number of channels
+     * @param proto Detector configuration copied to every channel
+     */
+    DetectorBank(size_t channels, const Detector &proto = Detector()) : _d(channels, proto) {}
+
+    void Clear() {
+        for (auto &d : _d) {
+            d.Clear();
+        }
+    }
+
+    /**
+     * @brief Push one sample per channel
+     * @param frame Samples, one per channel
+     * @param events Receives the event of each channel
+     * @return Number of channels raising an event
+     */
+    size_t Push(const _float_t *frame, change_t *events) {
+        size_t n = 0;
+        for (size_t i = 0; i < _d.size(); i++) {
+            events[i] = _d[i].Push(frame[i]);
+            n += events[i] != CHANGE_NONE;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Push one sample per channel, calling fn(channel, event) for each event
+     * @return Number of channels raising an event
+     */
+    template <typename Fn>
+    size_t Push(const _float_t *frame, Fn fn) {
+        size_t n = 0;
+        for (size_t i = 0; i < _d.size(); i++) {
+            change_t e = _d[i].Push(frame[i]);
+            if (e != CHANGE_NONE) {
+                fn(i, e);
+                n++;
+            }
+        }
+        return n;
+    }
+
+    Detector &operator[](size_t channel) {
+        return _d[channel];
+    }
+
+    size_t Channels() const {
+        return _d.size();
+    }
+
+  private:
+    std::vector<Detector> _d;
+};
@@ -30,6 +30,9 @@ public:
         return true;
     }
 
+    // oldest item, the one the next push() overwrites when full
+    const T& front() const { return buffer[tail]; }
+
     bool empty() const { return (!full && (head == tail)); }
     bool isFull() const { return full; }
     size_t size() const {
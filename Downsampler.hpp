@@ -0,0 +1,329 @@
+#pragma once
+
+// decimation of a sample stream for storage and charting
+//
+// Downsampler     - one summary (count, min, max, mean, variance, first, last)
+//                   per N samples and/or per time interval
+// LttbDownsampler - one representative sample per bucket, chosen by the
+//                   largest-triangle-three-buckets rule, which keeps spikes
+//                   and the visual shape of the curve
+//
+// Downsampler ds(1000);                 // 1 kHz in, one summary per second
+// if (ds.Push(x)) store(ds.Last());
+// ds.Push(samples, n, [](const DownsampleSummary &s) { store(s); });
+//
+// timestamps are whatever unit the caller uses (e.g. micros()); without
+// timestamps the sample index stands in for them.
+
+#include <stdint.h>
+#include <vector>
+
+#include "CircularBuffer.hpp"
+#include "RunningStats.hpp"
+
+struct DownsampleSummary {
+    uint64_t start, end; // timestamps of the first and last sample
+    _counter_t count;
+    _float_t min, max, mean, variance, first, last;
+};
+
+class Downsampler {
+  public:
+    /**
+     * @brief Constructor for Downsampler
+     * @param samples Close a summary after this many samples, 0 for no limit
+     * @param interval Close a summary when a timestamp crosses a multiple of
+     *        interval, 0 for no limit
+     */
+    Downsampler(_counter_t samples, uint64_t interval = 0) : _samples(samples), _interval(interval) {
+        Clear();
+    }
+
+    /**
+     * @brief Reset the instance to its initial state, dropping the open summary
+     */
+    void Clear() {
+        _rs.Clear();
+        _index = 0;
+        _bucketEnd = 0;
+        _out = _last = DownsampleSummary();
+    }
+
+    /**
+     * @brief Add a sample, timestamped with its index
+     * @return true if a summary was completed, see Last()
+     */
+    bool Push(_float_t x) {
+        return Push(_index, x);
+    }
+
+    /**
+     * @brief Add a timestamped sample
+     * @return true if a summary was completed, see Last()
+     */
+    bool Push(uint64_t t, _float_t x) {
+        bool closed = false;
+        Add(t, x, [&](const DownsampleSummary &s) {
+            _last = s;
+            closed = true;
+        });
+        return closed;
+    }
+
+    /**
+     * @brief Add a batch of samples, timestamped with their index
+     * @param emit Called with each summary completed
+     */
+    template <typename Fn>
+    void Push(const _float_t *x, size_t n, Fn emit) {
+        for (size_t i = 0; i < n; i++) {
+            Add(_index, x[i], emit);
+        }
+    }
+
+    /**
+     * @brief Add a batch of timestamped samples
+     * @param emit Called with each summary completed
+     */
+    template <typename Fn>
+    void Push(const uint64_t *t, const _float_t *x, size_t n, Fn emit) {
+        for (size_t i = 0; i < n; i++) {
+            Add(t[i], x[i], emit);
+        }
+    }
+
+    /**
+     * @brief Add the contents of a CircularBuffer, oldest first
+     * @param emit Called with each summary completed
+     */
+    template <typename Fn>
+    void Push(const CircularBuffer<_float_t> &cb, Fn emit) {
+        for (_float_t x : cb) {
+            Add(_index, x, emit);
+        }
+    }
+
+    /**
+     * @brief Close the open summary early, e.g. at the end of a capture
+     * @return true if there was one, see Last()
+     */
+    bool Flush() {
+        if (_rs.NumDataValues() == 0) {
+            return false;
+        }
+        Close(_last);
+        return true;
+    }
+
+    /**
+     * @brief The most recently completed summary
+     */
+    const DownsampleSummary &Last() const {
+        return _last;
+    }
+
+    /**
+     * @brief Statistics of the open summary so far
+     */
+    const RunningStats &Current() const {
+        return _rs;
+    }
+
+  private:
+    template <typename Fn>
+    void Add(uint64_t t, _float_t x, Fn &&emit) {
+        _index++;
+        if (_interval && _rs.NumDataValues() && t >= _bucketEnd) {
+            Close(_out);
+            emit(_out);
+        }
+        if (_rs.NumDataValues() == 0) {
+            _out.start = t;
+            _out.min = _out.max = _out.first = x;
+            if (_interval) {
+                _bucketEnd = (t / _interval + 1) * _interval;
+            }
+        } else if (x < _out.min) {
+            _out.min = x;
+        } else if (x > _out.max) {
+            _out.max = x;
+        }
+        _out.end = t;
+        _out.last = x;
+        _rs.Push(x);
+        if (_samples && _rs.NumDataValues() == _samples) {
+            Close(_out);
+            emit(_out);
+        }
+    }
+
+    void Close(DownsampleSummary &s) {
+        _out.count = _rs.NumDataValues();
+        _out.mean = _rs.Mean();
+        _out.variance = _out.count > 1 ? _rs.Variance() : 0;
+        s = _out;
+        _rs.Clear();
+    }
+
+    _counter_t _samples;
+    uint64_t _interval, _index, _bucketEnd;
+    RunningStats _rs;
+    DownsampleSummary _out, _last;
+};
+
+struct LttbPoint {
+    uint64_t t;
+    _float_t x;
+};
+
+// streaming LTTB: the point kept for a bucket depends on the average of the
+// following bucket, so output lags input by one bucket. Two bucket buffers
+// are allocated up front and swapped. The first sample is always kept, and
+// Flush() keeps the last one.
+class LttbDownsampler {
+  public:
+    /**
+     * @param bucket Input samples per output point
+     */
+    LttbDownsampler(size_t bucket) : _bucket(bucket ? bucket : 1), _cur(_bucket), _next(_bucket) {
+        Clear();
+    }
+
+    void Clear() {
+        _index = 0;
+        _ncur = _nnext = 0;
+        _started = false;
+        _sumt = _sumx = 0;
+    }
+
+    /**
+     * @brief Add a sample, timestamped with its index
+     * @return true if a point was selected, see Last()
+     */
+    bool Push(_float_t x) {
+        return Push(_index, x);
+    }
+
+    /**
+     * @brief Add a timestamped sample
+     * @return true if a point was selected, see Last()
+     */
+    bool Push(uint64_t t, _float_t x) {
+        bool selected = false;
+        Add(t, x, [&](const LttbPoint &) { selected = true; });
+        return selected;
+    }
+
+    /**
+     * @brief Add a batch of samples, timestamped with their index
+     * @param emit Called with each point selected
+     */
+    template <typename Fn>
+    void Push(const _float_t *x, size_t n, Fn emit) {
+        for (size_t i = 0; i < n; i++) {
+            Add(_index, x[i], emit);
+        }
+    }
+
+    /**
+     * @brief Add a batch of timestamped samples
+     * @param emit Called with each point selected
+     */
+    template <typename Fn>
+    void Push(const uint64_t *t, const _float_t *x, size_t n, Fn emit) {
+        for (size_t i = 0; i < n; i++) {
+            Add(t[i], x[i], emit);
+        }
+    }
+
+    /**
+     * @brief Select points for the buffered buckets, ending with the last sample
+     * @param emit Called with each point selected
+     */
+    template <typename Fn>
+    void Flush(Fn emit) {
+        if (_nnext) {
+            Select(_cur.data(), _ncur, Average(), emit);
+            _cur.swap(_next);
+            _ncur = _nnext;
+            _nnext = 0;
+            _sumt = _sumx = 0;
+        }
+        if (_ncur) {
+            if (_ncur > 1) {
+                Select(_cur.data(), _ncur - 1, _cur[_ncur - 1], emit);
+            }
+            _a = _cur[_ncur - 1];
+            emit(_a);
+            _ncur = 0;
+        }
+    }
+
+    /**
+     * @brief The most recently selected point
+     */
+    const LttbPoint &Last() const {
+        return _a;
+    }
+
+  private:
+    template <typename Fn>
+    void Add(uint64_t t, _float_t x, Fn &&emit) {
+        _index++;
+        if (!_started) {
+            _started = true;
+            _a = {t, x};
+            emit(_a);
+            return;
+        }
+        if (_ncur < _bucket) {
+            _cur[_ncur++] = {t, x};
+            return;
+        }
+        _next[_nnext] = {t, x};
+        // offsets from the bucket's first sample keep the sums small
+        _sumt += static_cast<_float_t>(t - _next[0].t);
+        _sumx += x;
+        if (++_nnext == _bucket) {
+            Select(_cur.data(), _ncur, Average(), emit);
+            _cur.swap(_next);
+            _nnext = 0;
+            _sumt = _sumx = 0;
+        }
+    }
+
+    LttbPoint Average() const {
+        _float_t dt = _sumt / _nnext;
+        return {_next[0].t + static_cast<uint64_t>(dt + static_cast<_float_t>(0.5)), _sumx / _nnext};
+    }
+
+    // keep the point of p[0..n) spanning the largest triangle with _a and c
+    template <typename Fn>
+    void Select(const LttbPoint *p, size_t n, const LttbPoint &c, Fn &&emit) {
+        _float_t ct = static_cast<_float_t>(static_cast<int64_t>(c.t - _a.t));
+        _float_t cx = c.x - _a.x;
+        _float_t best = -1;
+        size_t k = 0;
+        for (size_t i = 0; i < n; i++) {
+            _float_t bt = static_cast<_float_t>(static_cast<int64_t>(p[i].t - _a.t));
+            _float_t area = bt * cx - ct * (p[i].x - _a.x);
+            if (area < 0) {
+                area = -area;
+            }
+            if (area > best) {
+                best = area;
+                k = i;
+            }
+        }
+        _a = p[k];
+        emit(_a);
+    }
+
+    size_t _bucket;
+    std::vector<LttbPoint> _cur, _next;
+    size_t _ncur, _nnext;
+    uint64_t _index;
+    bool _started;
+    _float_t _sumt, _sumx; // of the next bucket
+    LttbPoint _a;          // last point selected
+};
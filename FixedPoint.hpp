@@ -0,0 +1,314 @@
+#pragma once
+
+// integer variants of RunningVariance, RollingVariance and ExponentialSmoothing
+// for cores without an FPU (ESP32-C2/C3 class), where every float division
+// goes through a soft-float library call.
+//
+// samples are int32_t in Q format: Q fractional bits, i.e. raw = x * 2^Q.
+// Q = 0 takes ADC counts as they are. Push() uses only integer add, subtract,
+// multiply and shift; the one 64-bit division per statistic happens at query
+// time.
+//
+// FixedRunningVariance<16> fv;
+// fv.Push(rs_to_fixed<16>(1.5));       // or raw ADC counts with Q = 0
+// int32_t m = fv.Mean();                // Q16
+// float sd = rs_from_fixed<16>(fv.StandardDeviation());
+//
+// overflow bounds: sums are taken over d = x - K, K being the first sample
+// pushed, so only the spread of the data matters, not its offset. With D the
+// largest |d| in raw units,
+//   sum of d   (int64_t)   exact while n * D   < 2^63
+//   sum of d^2 (uint64_t)  exact while n * D^2 < 2^64
+// Within these the variance is below 2^64 in units of 2^-2Q and the standard
+// deviation below 2^32, which is why Variance() returns a uint64_t and
+// StandardDeviation() a uint32_t: any two int32_t samples differ by up to
+// 2^32 - 1, beyond the signed types.
+// e.g. a 16 bit ADC (D < 2^16) at Q0 may push 2^32 samples, a Q16 value
+// spanning +-128.0 (D < 2^24) only 2^16. For long running statistics keep Q
+// as small as the resolution allows. Windowed sums subtract the sample leaving
+// the window exactly, so for them n is the window size and there is no drift.
+
+#include <stdint.h>
+
+#include "CircularBuffer.hpp"
+#include "rstypes.h"
+
+/**
+ * @brief Convert to Q format, rounding to nearest (host side or setup only)
+ */
+template <int Q>
+static inline int32_t rs_to_fixed(_float_t x) {
+    _float_t s = x * static_cast<_float_t>(int64_t(1) << Q);
+    return static_cast<int32_t>(s < 0 ? s - static_cast<_float_t>(0.5) : s + static_cast<_float_t>(0.5));
+}
+
+/**
+ * @brief Convert from Q format (host side or display only)
+ */
+template <int Q>
+static inline _float_t rs_from_fixed(int64_t raw) {
+    return static_cast<_float_t>(raw) / static_cast<_float_t>(int64_t(1) << Q);
+}
+
+// a / b rounded to nearest, b > 0
+static inline int64_t rs_div_round(int64_t a, int64_t b) {
+    return a < 0 ? -((-a + b / 2) / b) : (a + b / 2) / b;
+}
+
+// a / b rounded to nearest, b > 0, without forming a + b / 2
+static inline uint64_t rs_udiv_round(uint64_t a, uint64_t b) {
+    uint64_t q = a / b, r = a % b;
+    return q + (r >= b - r);
+}
+
+// floor(sqrt(v)), bit by bit
+static inline uint32_t rs_isqrt64(uint64_t v) {
+    uint64_t root = 0, bit = uint64_t(1) << 62;
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return static_cast<uint32_t>(root);
+}
+
+// d^2 for |d| < 2^32, squared unsigned: the signed product overflows
+// once |d| reaches 2^31.5
+static inline uint64_t rs_square(int64_t d) {
+    uint64_t a = d < 0 ? uint64_t(0) - uint64_t(d) : uint64_t(d);
+    return a * a;
+}
+
+// sum of (d - mean(d))^2 from the sums of d and d^2 without forming s1^2,
+// which would overflow long before s2 does: with s1 = m * n + r,
+// s1^2 / n = m^2 n + 2 m r + r^2 / n, each term bounded by s2.
+static inline uint64_t rs_fixed_ssd(int64_t s1, uint64_t s2, uint64_t n) {
+    int64_t m = s1 / static_cast<int64_t>(n);
+    int64_t r = s1 - m * static_cast<int64_t>(n);
+    uint64_t am = m < 0 ? -m : m;
+    uint64_t ar = r < 0 ? -r : r;
+    // m and r share the sign of s1, so 2 m r >= 0
+    uint64_t c = am * am * n + 2 * am * ar + ar * ar / n;
+    return s2 > c ? s2 - c : 0;
+}
+
+template <int Q, typename CounterT = _counter_t>
+class FixedRunningVariance {
+  public:
+    FixedRunningVariance() {
+        Clear();
+    }
+
+    /**
+     * @brief Reset all statistics to initial state
+     */
+    void Clear() {
+        n = 0;
+        K = 0;
+        S1 = 0;
+        S2 = 0;
+    }
+
+    /**
+     * @brief Add a new value to the statistics
+     * @param x The value to add, Q format
+     */
+    void Push(int32_t x) {
+        if (n == 0) {
+            K = x;
+        }
+        int64_t d = int64_t(x) - K;
+        n++;
+        S1 += d;
+        S2 += rs_square(d);
+    }
+
+    /**
+     * @brief Get the number of values added
+     */
+    CounterT NumDataValues() const {
+        return n;
+    }
+
+    /**
+     * @brief Get the mean of the values, rounded, Q format
+     */
+    int32_t Mean() const {
+        return n ? static_cast<int32_t>(K + rs_div_round(S1, n)) : 0;
+    }
+
+    /**
+     * @brief Get the sample variance (n-1 denominator), Q format
+     */
+    uint64_t Variance() const {
+        return n > 1 ? rs_udiv_round(rs_fixed_ssd(S1, S2, n), uint64_t(n - 1) << Q) : 0;
+    }
+
+    /**
+     * @brief Get the sample standard deviation, Q format
+     */
+    uint32_t StandardDeviation() const {
+        // the variance in units of 2^-2Q is the square of a Q value
+        return n > 1 ? rs_isqrt64(rs_fixed_ssd(S1, S2, n) / (n - 1)) : 0;
+    }
+
+  private:
+    CounterT n;
+    int32_t K;  // first sample, the sums are of x - K
+    int64_t S1; // sum of x - K
+    uint64_t S2; // sum of (x - K)^2
+};
+
+// exact sums over the last window_size samples, kept in a CircularBuffer.
+// Unlike RollingVariance the statistics cover the samples seen so far while
+// the window fills, not a zero-filled window.
+template <int Q>
+class FixedRollingVariance {
+  public:
+    /**
+     * @brief Constructor for FixedRollingVariance
+     * @param window_size The size of the window for variance calculation
+     */
+    FixedRollingVariance(size_t window_size) : _window(window_size) {
+        Clear();
+    }
+
+    /**
+     * @brief Reset the instance to its initial state
+     */
+    void Clear() {
+        _window.clear();
+        _ref = 0;
+        _s1 = 0;
+        _s2 = 0;
+    }
+
+    /**
+     * @brief Add a new value to the window, replacing the oldest once full
+     * @param x The new value, Q format
+     */
+    void Push(int32_t x) {
+        if (_window.empty()) {
+            _ref = x;
+        }
+        if (_window.isFull()) {
+            int64_t d = int64_t(_window.front()) - _ref;
+            _s1 -= d;
+            _s2 -= rs_square(d);
+        }
+        int64_t d = int64_t(x) - _ref;
+        _s1 += d;
+        _s2 += rs_square(d);
+        _window.push(x);
+    }
+
+    /**
+     * @brief Get the mean of the window, rounded, Q format
+     */
+    int32_t Mean() const {
+        size_t n = _window.size();
+        return n ? static_cast<int32_t>(_ref + rs_div_round(_s1, n)) : 0;
+    }
+
+    /**
+     * @brief Get the variance of the window (n denominator), Q format
+     */
+    uint64_t Variance() const {
+        size_t n = _window.size();
+        return n ? rs_udiv_round(rs_fixed_ssd(_s1, _s2, n), uint64_t(n) << Q) : 0;
+    }
+
+    /**
+     * @brief Get the standard deviation of the window, Q format
+     */
+    uint32_t StandardDeviation() const {
+        size_t n = _window.size();
+        return n ? rs_isqrt64(rs_fixed_ssd(_s1, _s2, n) / n) : 0;
+    }
+
+    /**
+     * @brief Get the window size
+     */
+    size_t getWindowSize() const {
+        return _window.capacity();
+    }
+
+    const CircularBuffer<int32_t> &Window() const {
+        return _window;
+    }
+
+  private:
+    CircularBuffer<int32_t> _window;
+    int32_t _ref;  // first sample, the sums are of x - _ref
+    int64_t _s1;
+    uint64_t _s2;
+};
+
+// ExponentialSmoothing with alpha = 2^-shift: value += (x - value) * alpha
+// as a shift. The state keeps shift extra fractional bits, so small steps
+// are not truncated away and the output settles on a constant input exactly.
+// Bound: |x| * 2^shift < 2^62.
+template <int Q>
+class FixedExponentialSmoothing {
+  public:
+    /**
+     * @param shift alpha = 2^-shift, e.g. 3 for 0.125
+     */
+    FixedExponentialSmoothing(uint8_t shift = 0) : _shift(shift), _primed(false), _acc(0) {}
+
+    uint8_t Shift(void) const {
+        return _shift;
+    }
+
+    void setShift(uint8_t shift) {
+        if (_primed) {
+            // multiply rather than shift: _acc may be negative
+            _acc = (_acc >> _shift) * (int64_t(1) << shift);
+        }
+        _shift = shift;
+    }
+
+    /**
+     * @brief The nearest power of two alpha, for porting ExponentialSmoothing settings
+     */
+    static uint8_t ShiftForAlpha(_float_t alpha) {
+        uint8_t s = 0;
+        while (s < 30 && static_cast<_float_t>(1.0) / static_cast<_float_t>(uint32_t(1) << s) > alpha * static_cast<_float_t>(1.4142135)) {
+            s++;
+        }
+        return s;
+    }
+
+    /**
+     * @brief Current value, Q format
+     */
+    int32_t Value(void) const {
+        return static_cast<int32_t>(_acc >> _shift);
+    }
+
+    void Push(int32_t x) {
+        if (!_primed) {
+            _acc = int64_t(x) * (int64_t(1) << _shift);
+            _primed = true;
+        } else {
+            _acc += x - (_acc >> _shift);
+        }
+    }
+
+    int32_t Smooth(int32_t x) {
+        Push(x);
+        return Value();
+    }
+
+  private:
+    uint8_t _shift;
+    bool _primed;
+    int64_t _acc; // value << _shift
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// hash helpers shared by the keyed tables and sketches
+
+/**
+ * @brief splitmix64 finalizer - spreads low-entropy keys (small integers,
+ *        pointers) over all 64 bits
+ */
+static inline uint64_t HashMix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * @brief Hash a byte string, consuming 8 bytes per step
+ */
+static inline uint64_t HashBytes(const void *data, size_t len) {
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ len;
+    uint64_t w;
+
+    while (len >= 8) {
+        memcpy(&w, p, 8);
+        h = (h ^ HashMix64(w)) * 0x9FB21C651E98DF25ULL;
+        p += 8;
+        len -= 8;
+    }
+    w = 0;
+    memcpy(&w, p, len);
+    h ^= HashMix64(w);
+    return HashMix64(h);
+}
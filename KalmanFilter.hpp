@@ -0,0 +1,430 @@
+#pragma once
+
+// linear Kalman filter with N = 1..4 states and a scalar measurement
+//
+// KalmanFilter<1> level(1e-5, 0.01);     // random walk: q, r
+// _float_t y = level.Push(z);            // like ExponentialSmoothing, but
+//                                        // the gain follows q/r and P
+//
+// KalmanFilter<2> cv;                    // constant velocity
+// _float_t F[2][2] = {{1, dt}, {0, 1}};
+// cv.SetTransition(F);
+//
+// all matrices are fixed-size arrays and loops run over the compile time N,
+// so they unroll; nothing is allocated. With a scalar measurement the
+// innovation covariance S is a number and the update needs no inverse.
+//
+// AdaptiveKalmanFilter estimates the measurement noise R from the
+// RollingVariance of the innovations (E[y^2] = H P H^T + R).
+// KalmanBank runs one filter per channel on a whole frame, state stored as
+// structure of arrays so each step is a loop over channels in SIMD lanes.
+
+#include <algorithm>
+#include <stddef.h>
+#include <vector>
+
+#include "RollingVariance.hpp"
+#include "rstypes.h"
+
+template <int N, typename T = _float_t>
+class KalmanFilter {
+    static_assert(N >= 1 && N <= 4, "KalmanFilter supports 1 to 4 states");
+
+  public:
+    /**
+     * @param q Process noise, Q = q * I
+     * @param r Measurement noise variance
+     * @param p0 Initial state variance
+     */
+    KalmanFilter(T q = static_cast<T>(1e-5), T r = static_cast<T>(1e-2), T p0 = static_cast<T>(1e3))
+        : _r(r), _p0(p0) {
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < N; j++) {
+                _F[i][j] = i == j ? 1 : 0;
+                _Q[i][j] = i == j ? q : 0;
+            }
+            _H[i] = i == 0 ? 1 : 0;
+        }
+        Clear();
+    }
+
+    /**
+     * @brief Reset state to zero with the initial variance, keeping the model
+     */
+    void Clear() {
+        for (int i = 0; i < N; i++) {
+            _x[i] = 0;
+            for (int j = 0; j < N; j++) {
+                _P[i][j] = i == j ? _p0 : 0;
+            }
+        }
+        _y = _s = 0;
+    }
+
+    void SetTransition(const T (&F)[N][N]) {
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < N; j++)
+                _F[i][j] = F[i][j];
+    }
+
+    void SetProcessNoise(const T (&Q)[N][N]) {
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < N; j++)
+                _Q[i][j] = Q[i][j];
+    }
+
+    void SetObservation(const T (&H)[N]) {
+        for (int i = 0; i < N; i++)
+            _H[i] = H[i];
+    }
+
+    void SetMeasurementNoise(T r) {
+        _r = r;
+    }
+
+    T MeasurementNoise() const {
+        return _r;
+    }
+
+    /**
+     * @brief Time update: x = F x, P = F P F^T + Q
+     */
+    void Predict() {
+        T x[N], FP[N][N];
+        for (int i = 0; i < N; i++) {
+            x[i] = 0;
+            for (int k = 0; k < N; k++) {
+                x[i] += _F[i][k] * _x[k];
+            }
+            for (int j = 0; j < N; j++) {
+                FP[i][j] = 0;
+                for (int k = 0; k < N; k++) {
+                    FP[i][j] += _F[i][k] * _P[k][j];
+                }
+            }
+        }
+        for (int i = 0; i < N; i++) {
+            _x[i] = x[i];
+            for (int j = 0; j < N; j++) {
+                T p = _Q[i][j];
+                for (int k = 0; k < N; k++) {
+                    p += FP[i][k] * _F[j][k];
+                }
+                _P[i][j] = p;
+            }
+        }
+    }
+
+    /**
+     * @brief Measurement update with z = H x + noise
+     * @return The innovation z - H x
+     */
+    T Update(T z) {
+        T PHt[N], hx = 0, hph = 0;
+        for (int i = 0; i < N; i++) {
+            hx += _H[i] * _x[i];
+            PHt[i] = 0;
+            for (int j = 0; j < N; j++) {
+                PHt[i] += _P[i][j] * _H[j];
+            }
+        }
+        for (int i = 0; i < N; i++) {
+            hph += _H[i] * PHt[i];
+        }
+        _y = z - hx;
+        _s = hph + _r;
+        T inv = static_cast<T>(1) / _s;
+        // P = (I - K H) P = P - K (P H^T)^T, K = P H^T / S
+        for (int i = 0; i < N; i++) {
+            T k = PHt[i] * inv;
+            _x[i] += k * _y;
+            for (int j = 0; j < N; j++) {
+                _P[i][j] -= k * PHt[j];
+            }
+        }
+        return _y;
+    }
+
+    /**
+     * @brief Predict and update with one measurement
+     * @return The filtered measurement H x
+     */
+    T Push(T z) {
+        Predict();
+        Update(z);
+        return Value();
+    }
+
+    /**
+     * @brief The filtered measurement H x
+     */
+    T Value() const {
+        T v = 0;
+        for (int i = 0; i < N; i++) {
+            v += _H[i] * _x[i];
+        }
+        return v;
+    }
+
+    T State(int i) const {
+        return _x[i];
+    }
+
+    void SetState(int i, T v) {
+        _x[i] = v;
+    }
+
+    T Covariance(int i, int j) const {
+        return _P[i][j];
+    }
+
+    /**
+     * @brief Innovation z - H x of the last update
+     */
+    T Innovation() const {
+        return _y;
+    }
+
+    /**
+     * @brief Innovation variance S = H P H^T + R of the last update
+     */
+    T InnovationVariance() const {
+        return _s;
+    }
+
+  private:
+    template <int, typename>
+    friend class KalmanBank;
+
+    T _x[N], _P[N][N];
+    T _F[N][N], _Q[N][N], _H[N];
+    T _r, _p0;
+    T _y, _s;
+};
+
+// R follows the innovations: over a window, var(y) = H P H^T + R, so
+// R = var(y) - (S - R), floored at min_r. Adapts once the window is full.
+template <int N, typename T = _float_t>
+class AdaptiveKalmanFilter {
+  public:
+    /**
+     * @param window Innovations the variance is taken over
+     * @param proto Filter model and initial R
+     * @param min_r Lower bound of the estimated R
+     */
+    AdaptiveKalmanFilter(size_t window, const KalmanFilter<N, T> &proto = KalmanFilter<N, T>(),
+                         T min_r = static_cast<T>(1e-9))
+        : _kf(proto), _innov(window), _min_r(min_r), _n(0) {}
+
+    void Clear() {
+        _kf.Clear();
+        _innov.Clear();
+        _n = 0;
+    }
+
+    T Push(T z) {
+        _kf.Predict();
+        T y = _kf.Update(z);
+        _innov.Push(y);
+        if (++_n >= _innov.getWindowSize()) {
+            T hph = _kf.InnovationVariance() - _kf.MeasurementNoise();
+            T r = _innov.Variance() - hph;
+            _kf.SetMeasurementNoise(r > _min_r ? r : _min_r);
+        }
+        return _kf.Value();
+    }
+
+    T Value() const {
+        return _kf.Value();
+    }
+
+    T MeasurementNoise() const {
+        return _kf.MeasurementNoise();
+    }
+
+    const KalmanFilter<N, T> &Filter() const {
+        return _kf;
+    }
+
+  private:
+    KalmanFilter<N, T> _kf;
+    RollingVariance<T, RS_PLAIN> _innov;
+    T _min_r;
+    size_t _n;
+};
+
+// one filter per channel with a shared model (F, Q, H) and per-channel R.
+// Channels are padded to a multiple of Lanes; every step loops over the
+// Lanes channels of a block with a constant trip count, which vectorizes.
+template <int N, typename T = _float_t>
+class KalmanBank {
+  public:
+    enum { Lanes = 64 };
+
+    /**
+     * @param channels Number of channels
+     * @param proto Model, R and initial state copied to every channel
+     */
+    KalmanBank(size_t channels, const KalmanFilter<N, T> &proto = KalmanFilter<N, T>())
+        : _channels(channels), _stride((channels + Lanes - 1) / Lanes * Lanes), _proto(proto),
+          _x(N * _stride), _P(N * N * _stride), _r(_stride), _y(_stride), _s(_stride), _z(_stride),
+          _scratch(1) {
+        Clear();
+    }
+
+    void Clear() {
+        for (size_t c = 0; c < _stride; c++) {
+            for (int i = 0; i < N; i++) {
+                _x[i * _stride + c] = _proto._x[i];
+                for (int j = 0; j < N; j++) {
+                    _P[(i * N + j) * _stride + c] = _proto._P[i][j];
+                }
+            }
+            _r[c] = _proto._r;
+            _y[c] = _s[c] = _z[c] = 0;
+        }
+    }
+
+    /**
+     * @brief Predict and update every channel
+     * @param z One measurement per channel
+     * @param out If given, receives the filtered measurement per channel
+     */
+    void Push(const T *z, T *out = nullptr) {
+        std::copy(z, z + _channels, _z.begin());
+        for (size_t b = 0; b < _stride; b += Lanes) {
+            Step(b);
+        }
+        if (out) {
+            for (size_t c = 0; c < _channels; c++) {
+                out[c] = Value(c);
+            }
+        }
+    }
+
+    T Value(size_t ch) const {
+        T v = 0;
+        for (int i = 0; i < N; i++) {
+            v += _proto._H[i] * _x[i * _stride + ch];
+        }
+        return v;
+    }
+
+    T State(size_t ch, int i) const {
+        return _x[i * _stride + ch];
+    }
+
+    T Innovation(size_t ch) const {
+        return _y[ch];
+    }
+
+    T InnovationVariance(size_t ch) const {
+        return _s[ch];
+    }
+
+    void SetMeasurementNoise(size_t ch, T r) {
+        _r[ch] = r;
+    }
+
+    size_t Channels() const {
+        return _channels;
+    }
+
+  private:
+    void Step(size_t b) {
+        const KalmanFilter<N, T> &m = _proto;
+        Scratch *__restrict t = _scratch.data();
+        T(&xp)[N][Lanes] = t->xp;
+        T(&FP)[N][N][Lanes] = t->FP;
+        T(&Pp)[N][N][Lanes] = t->Pp;
+        T(&PHt)[N][Lanes] = t->PHt;
+        T(&hx)[Lanes] = t->hx;
+        T(&s)[Lanes] = t->s;
+
+        for (int i = 0; i < N; i++) {
+            for (int l = 0; l < Lanes; l++) {
+                xp[i][l] = 0;
+            }
+            for (int k = 0; k < N; k++) {
+                const T *x = &_x[k * _stride + b];
+                for (int l = 0; l < Lanes; l++) {
+                    xp[i][l] += m._F[i][k] * x[l];
+                }
+            }
+            for (int j = 0; j < N; j++) {
+                for (int l = 0; l < Lanes; l++) {
+                    FP[i][j][l] = 0;
+                }
+                for (int k = 0; k < N; k++) {
+                    const T *p = &_P[(k * N + j) * _stride + b];
+                    for (int l = 0; l < Lanes; l++) {
+                        FP[i][j][l] += m._F[i][k] * p[l];
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < N; j++) {
+                for (int l = 0; l < Lanes; l++) {
+                    Pp[i][j][l] = m._Q[i][j];
+                }
+                for (int k = 0; k < N; k++) {
+                    for (int l = 0; l < Lanes; l++) {
+                        Pp[i][j][l] += FP[i][k][l] * m._F[j][k];
+                    }
+                }
+            }
+        }
+
+        for (int l = 0; l < Lanes; l++) {
+            hx[l] = 0;
+            s[l] = _r[b + l];
+        }
+        for (int i = 0; i < N; i++) {
+            for (int l = 0; l < Lanes; l++) {
+                hx[l] += m._H[i] * xp[i][l];
+                PHt[i][l] = 0;
+            }
+            for (int j = 0; j < N; j++) {
+                for (int l = 0; l < Lanes; l++) {
+                    PHt[i][l] += Pp[i][j][l] * m._H[j];
+                }
+            }
+        }
+        for (int i = 0; i < N; i++) {
+            for (int l = 0; l < Lanes; l++) {
+                s[l] += m._H[i] * PHt[i][l];
+            }
+        }
+
+        T *y = &_y[b], *sv = &_s[b];
+        const T *z = &_z[b];
+        for (int l = 0; l < Lanes; l++) {
+            y[l] = z[l] - hx[l];
+            sv[l] = s[l];
+            s[l] = static_cast<T>(1) / s[l];
+        }
+        for (int i = 0; i < N; i++) {
+            T *x = &_x[i * _stride + b];
+            for (int l = 0; l < Lanes; l++) {
+                x[l] = xp[i][l] + PHt[i][l] * s[l] * y[l];
+            }
+            for (int j = 0; j < N; j++) {
+                T *p = &_P[(i * N + j) * _stride + b];
+                for (int l = 0; l < Lanes; l++) {
+                    p[l] = Pp[i][j][l] - PHt[i][l] * s[l] * PHt[j][l];
+                }
+            }
+        }
+    }
+
+    // per-block temporaries, on the heap rather than the (small) task stack
+    struct Scratch {
+        T xp[N][Lanes], FP[N][N][Lanes], Pp[N][N][Lanes], PHt[N][Lanes], hx[Lanes], s[Lanes];
+    };
+
+    size_t _channels, _stride;
+    KalmanFilter<N, T> _proto;
+    std::vector<T> _x, _P, _r, _y, _s, _z;
+    std::vector<Scratch> _scratch;
+};
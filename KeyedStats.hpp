@@ -0,0 +1,401 @@
+#pragma once
+
+// per-key accumulators for high-cardinality keys (e.g. latency per endpoint/tenant)
+//
+// open addressing with linear probing and backward-shift deletion, no tombstones.
+// slots are kept in parallel arrays: probing only touches the 8-byte hash array,
+// the accumulators are stored inline (no nodes, no pointer chasing).
+// string keys are copied into a fixed-size arena; when it runs full and at
+// least half of it belongs to erased keys it is compacted in place, otherwise
+// the new key is rejected, so memory stays bounded by the constructor
+// arguments and an insert never allocates.
+//
+// KeyedStats<std::string_view, RunningStats> ks(200000);
+// uint64_t h = ks.Hash("GET /api|tenant42");   // hash once, reuse
+// ks.PushHashed("GET /api|tenant42", h, latency);
+// ks.Tick();                                  // once per epoch, e.g. every second
+//
+// Accumulator must be default constructible and provide Clear() and Push(...);
+// MergeFrom() additionally needs operator+.
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Hashing.hpp"
+
+/**
+ * @brief Key storage policy - trivially copyable keys are stored inline
+ */
+template <typename Key>
+struct KeyedStatsKey {
+    typedef Key stored_t;
+    typedef const Key &lookup_t;
+    static const size_t defaultKeyBytes = 0;
+
+    static uint64_t Hash(lookup_t key) {
+        return HashMix64(std::hash<Key>()(key));
+    }
+    static bool Store(lookup_t key, std::vector<char> &, size_t &, stored_t &out) {
+        out = key;
+        return true;
+    }
+    static lookup_t View(const stored_t &s, const char *) {
+        return s;
+    }
+    static bool Equal(const stored_t &s, const char *, lookup_t key) {
+        return s == key;
+    }
+    static size_t Bytes(lookup_t) {
+        return 0;
+    }
+    static size_t Offset(const stored_t &) {
+        return 0;
+    }
+    static void Relocate(stored_t &, char *, size_t &) {}
+};
+
+/**
+ * @brief Key storage policy for strings - bytes live in the table's arena
+ */
+struct KeyedStatsStringKey {
+    struct stored_t {
+        uint32_t offset, length;
+    };
+    typedef std::string_view lookup_t;
+    static const size_t defaultKeyBytes = 32;
+
+    static uint64_t Hash(lookup_t key) {
+        return HashBytes(key.data(), key.size());
+    }
+    static bool Store(lookup_t key, std::vector<char> &arena, size_t &used, stored_t &out) {
+        if (key.size() > arena.size() - used) {
+            return false;
+        }
+        if (key.size()) {
+            memcpy(arena.data() + used, key.data(), key.size());
+        }
+        out.offset = used;
+        out.length = key.size();
+        used += key.size();
+        return true;
+    }
+    static lookup_t View(const stored_t &s, const char *arena) {
+        return lookup_t(arena + s.offset, s.length);
+    }
+    static bool Equal(const stored_t &s, const char *arena, lookup_t key) {
+        return s.length == key.size() && memcmp(arena + s.offset, key.data(), s.length) == 0;
+    }
+    static size_t Bytes(lookup_t key) {
+        return key.size();
+    }
+    static size_t Offset(const stored_t &s) {
+        return s.offset;
+    }
+    // move the bytes of s down to used, within the same arena
+    static void Relocate(stored_t &s, char *arena, size_t &used) {
+        if (s.length) {
+            memmove(arena + used, arena + s.offset, s.length);
+        }
+        s.offset = used;
+        used += s.length;
+    }
+};
+
+template <>
+struct KeyedStatsKey<std::string_view> : KeyedStatsStringKey {};
+template <>
+struct KeyedStatsKey<std::string> : KeyedStatsStringKey {};
+
+template <typename Key, typename Accumulator, typename Traits = KeyedStatsKey<Key>>
+class KeyedStats {
+  public:
+    typedef typename Traits::lookup_t lookup_t;
+    typedef typename Traits::stored_t stored_t;
+
+    /**
+     * @brief Constructor for KeyedStats
+     * @param capacity Maximum number of keys held at once
+     * @param arenaBytes Size of the string key arena, 0 for a default per key
+     */
+    KeyedStats(size_t capacity, size_t arenaBytes = 0)
+        : _size(0), _epoch(0), _maxIdle(0), _arenaUsed(0), _arenaDead(0) {
+        size_t slots = 8;
+        while (slots < capacity + capacity / 7 + 1) {
+            slots <<= 1;
+        }
+        _mask = slots - 1;
+        _capacity = capacity;
+        _hashes.assign(slots, 0);
+        _keys.resize(slots);
+        _touched.assign(slots, 0);
+        _accs.resize(slots);
+        _arena.resize(arenaBytes ? arenaBytes : capacity * Traits::defaultKeyBytes);
+        _order.resize(_arena.empty() ? 0 : capacity);
+    }
+
+    /**
+     * @brief Remove all keys
+     */
+    void Clear() {
+        std::fill(_hashes.begin(), _hashes.end(), 0);
+        _size = 0;
+        _arenaUsed = 0;
+        _arenaDead = 0;
+    }
+
+    /**
+     * @brief Hash a key the way the table does; use with the *Hashed() calls
+     */
+    static uint64_t Hash(lookup_t key) {
+        uint64_t h = Traits::Hash(key);
+        return h ? h : 1; // 0 marks an empty slot
+    }
+
+    /**
+     * @brief Push a sample into the accumulator for key, creating it if needed
+     * @return false if the key is new and the table or key arena is full
+     */
+    template <typename... Args>
+    bool Push(lookup_t key, Args... x) {
+        return PushHashed(key, Hash(key), x...);
+    }
+
+    template <typename... Args>
+    bool PushHashed(lookup_t key, uint64_t hash, Args... x) {
+        Accumulator *acc = InsertHashed(key, hash);
+        if (acc == nullptr) {
+            return false;
+        }
+        acc->Push(x...);
+        return true;
+    }
+
+    /**
+     * @brief Get the accumulator for key, creating a cleared one if needed
+     * @return nullptr if the key is new and the table or key arena is full
+     */
+    Accumulator *Insert(lookup_t key) {
+        return InsertHashed(key, Hash(key));
+    }
+
+    Accumulator *InsertHashed(lookup_t key, uint64_t hash) {
+        hash = hash ? hash : 1;
+        size_t i = hash & _mask;
+        for (;;) {
+            uint64_t h = _hashes[i];
+            if (h == 0) {
+                break;
+            }
+            if (h == hash && Traits::Equal(_keys[i], _arena.data(), key)) {
+                _touched[i] = _epoch;
+                return &_accs[i];
+            }
+            i = (i + 1) & _mask;
+        }
+        if (_size >= _capacity || !StoreKey(key, _keys[i])) {
+            return nullptr;
+        }
+        _hashes[i] = hash;
+        _touched[i] = _epoch;
+        _accs[i].Clear();
+        _size++;
+        return &_accs[i];
+    }
+
+    /**
+     * @brief Look up the accumulator for key without creating or touching it
+     * @return nullptr if key is not present
+     */
+    const Accumulator *Find(lookup_t key) const {
+        return FindHashed(key, Hash(key));
+    }
+
+    const Accumulator *FindHashed(lookup_t key, uint64_t hash) const {
+        size_t i = Lookup(key, hash ? hash : 1);
+        return i == npos ? nullptr : &_accs[i];
+    }
+
+    /**
+     * @brief Remove key from the table
+     * @return true if the key was present
+     */
+    bool Erase(lookup_t key) {
+        size_t i = Lookup(key, Hash(key));
+        if (i == npos) {
+            return false;
+        }
+        EraseAt(i);
+        return true;
+    }
+
+    /**
+     * @brief Advance the idle clock by one epoch, evicting keys idle for
+     *        more than the SetMaxIdle() limit if one is set
+     */
+    void Tick() {
+        _epoch++;
+        if (_maxIdle) {
+            EvictIdle(_maxIdle);
+        }
+    }
+
+    /**
+     * @brief Set the automatic eviction limit applied by Tick(), 0 disables
+     * @param epochs Number of Tick() calls a key may go without a Push
+     */
+    void SetMaxIdle(uint32_t epochs) {
+        _maxIdle = epochs;
+    }
+
+    /**
+     * @brief Remove all keys not pushed to for more than maxIdle epochs
+     * @return Number of keys evicted
+     */
+    size_t EvictIdle(uint32_t maxIdle) {
+        size_t evicted = 0;
+        size_t i = 0;
+        while (i <= _mask) {
+            // backward shift refills slot i, so look at it again
+            if (_hashes[i] && uint32_t(_epoch - _touched[i]) > maxIdle) {
+                EraseAt(i);
+                evicted++;
+            } else {
+                i++;
+            }
+        }
+        return evicted;
+    }
+
+    /**
+     * @brief Merge all keys of other into this table using Accumulator's operator+
+     * @return Number of keys dropped because this table ran full
+     */
+    size_t MergeFrom(const KeyedStats &other) {
+        size_t dropped = 0;
+        if (&other == this) {
+            return 0;
+        }
+        for (size_t i = 0; i <= other._mask; i++) {
+            if (other._hashes[i] == 0) {
+                continue;
+            }
+            size_t before = _size;
+            Accumulator *acc = InsertHashed(Traits::View(other._keys[i], other._arena.data()),
+                                            other._hashes[i]);
+            if (acc == nullptr) {
+                dropped++;
+            } else if (_size != before) {
+                *acc = other._accs[i];
+            } else {
+                *acc = *acc + other._accs[i];
+            }
+        }
+        return dropped;
+    }
+
+    /**
+     * @brief Call fn(key, accumulator) for every key, in table order
+     */
+    template <typename Fn>
+    void ForEach(Fn fn) const {
+        for (size_t i = 0; i <= _mask; i++) {
+            if (_hashes[i]) {
+                fn(Traits::View(_keys[i], _arena.data()), _accs[i]);
+            }
+        }
+    }
+
+    size_t Size() const {
+        return _size;
+    }
+
+    size_t Capacity() const {
+        return _capacity;
+    }
+
+    uint32_t Epoch() const {
+        return _epoch;
+    }
+
+  private:
+    static const size_t npos = ~size_t(0);
+
+    size_t Lookup(lookup_t key, uint64_t hash) const {
+        size_t i = hash & _mask;
+        for (;;) {
+            uint64_t h = _hashes[i];
+            if (h == 0) {
+                return npos;
+            }
+            if (h == hash && Traits::Equal(_keys[i], _arena.data(), key)) {
+                return i;
+            }
+            i = (i + 1) & _mask;
+        }
+    }
+
+    void EraseAt(size_t i) {
+        _arenaDead += Traits::Bytes(Traits::View(_keys[i], _arena.data()));
+        size_t hole = i;
+        size_t j = i;
+        for (;;) {
+            j = (j + 1) & _mask;
+            uint64_t h = _hashes[j];
+            if (h == 0) {
+                break;
+            }
+            // move j into the hole unless its home slot lies in (hole, j]
+            size_t home = h & _mask;
+            if (((j - home) & _mask) >= ((j - hole) & _mask)) {
+                _hashes[hole] = h;
+                _keys[hole] = _keys[j];
+                _touched[hole] = _touched[j];
+                _accs[hole] = _accs[j];
+                hole = j;
+            }
+        }
+        _hashes[hole] = 0;
+        _size--;
+    }
+
+    bool StoreKey(lookup_t key, stored_t &out) {
+        if (Traits::Store(key, _arena, _arenaUsed, out)) {
+            return true;
+        }
+        // compact only if that frees room for the key and at least half the
+        // arena, so compactions cost O(1) amortized per byte stored
+        size_t reclaimable = _arenaDead + (_arena.size() - _arenaUsed);
+        if (_arenaDead < _arena.size() / 2 || reclaimable < Traits::Bytes(key)) {
+            return false;
+        }
+        // slide the live keys down in arena order
+        size_t n = 0;
+        for (size_t i = 0; i <= _mask; i++) {
+            if (_hashes[i]) {
+                _order[n++] = uint32_t(i);
+            }
+        }
+        std::sort(_order.begin(), _order.begin() + n,
+                  [this](uint32_t a, uint32_t b) { return Traits::Offset(_keys[a]) < Traits::Offset(_keys[b]); });
+        size_t used = 0;
+        for (size_t j = 0; j < n; j++) {
+            Traits::Relocate(_keys[_order[j]], _arena.data(), used);
+        }
+        _arenaUsed = used;
+        _arenaDead = 0;
+        return Traits::Store(key, _arena, _arenaUsed, out);
+    }
+
+    std::vector<uint64_t> _hashes;
+    std::vector<stored_t> _keys;
+    std::vector<uint32_t> _touched;
+    std::vector<Accumulator> _accs;
+    std::vector<char> _arena;
+    std::vector<uint32_t> _order; // live slots by arena offset, for compaction
+    size_t _mask, _capacity, _size;
+    uint32_t _epoch, _maxIdle;
+    size_t _arenaUsed, _arenaDead;
+};
@@ -0,0 +1,348 @@
+#pragma once
+
+// render a registry of named accumulators as Prometheus text or JSON
+//
+// std::mutex statsLock;                           // held by the writers while pushing
+// MetricsExporter ex(statsLock);
+// ex.Add("http_latency_us", latency, {{"endpoint", "get"}});
+// ex.Add("http_latency_us", putLatency, {{"endpoint", "put"}});
+// ex.Add("loop_rate_hz", rate);                    // TimerStats, RateStats, ...
+// ex.Capture();                                    // snapshot phase
+// size_t n = ex.RenderPrometheus(buf, sizeof(buf)); // format phase
+//
+// Capture() copies count, mean and variance of every series into a
+// preallocated table; the Render functions only format that table. An
+// exporter constructed with the writers' mutex holds it for the whole
+// Capture(), so one scrape is a consistent cut across all series, and
+// formatting then runs without it. SeqlockStats series are read with
+// Snapshot(), so they are consistent per series even without a mutex.
+//
+// the Render functions write into the caller's buffer and return the length
+// of the complete output, like snprintf: if that is >= size, the output was
+// truncated and the buffer should grow. Numbers are formatted with
+// std::to_chars (shortest round-trip form). Nothing allocates after the
+// series are registered.
+//
+// Prometheus: per metric name a summary family (<name>_count, <name>_sum)
+// plus gauges <name>_mean and <name>_stddev, series grouped by name.
+
+#include <charconv>
+#include <initializer_list>
+#include <math.h>
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SeqlockStats.hpp"
+
+struct MetricSnapshot {
+    uint64_t count;
+    double mean, variance;
+};
+
+/**
+ * @brief How a series is read: anything with NumDataValues(), Mean() and
+ *        Variance(), e.g. RunningStats, TimerStats, RateStats, RunningVariance
+ */
+template <typename Accumulator>
+struct MetricCapture {
+    static void Capture(const Accumulator &acc, MetricSnapshot &out) {
+        out.count = acc.NumDataValues();
+        out.mean = acc.Mean();
+        out.variance = out.count > 1 ? double(acc.Variance()) : 0.0;
+    }
+};
+
+/**
+ * @brief SeqlockStats series are read through a consistent Snapshot()
+ */
+template <typename Accumulator>
+struct MetricCapture<SeqlockStats<Accumulator>> {
+    static void Capture(const SeqlockStats<Accumulator> &acc, MetricSnapshot &out) {
+        typename SeqlockStats<Accumulator>::snapshot_t s = acc.Snapshot();
+        MetricCapture<typename SeqlockStats<Accumulator>::snapshot_t>::Capture(s, out);
+    }
+};
+
+class MetricsExporter {
+  public:
+    typedef std::initializer_list<std::pair<const char *, const char *>> labels_t;
+
+    MetricsExporter() : _writers(nullptr) {}
+
+    /**
+     * @brief Constructor for an exporter whose Capture() holds writers
+     * @param writers Mutex the accumulators are pushed under; must outlive the exporter
+     */
+    explicit MetricsExporter(std::mutex &writers) : _writers(&writers) {}
+
+    /**
+     * @brief Register a series; the accumulator must outlive the exporter
+     * @param name Metric name, characters outside [a-zA-Z0-9_:] become '_'
+     * @param labels Label name/value pairs of this series; in label names
+     *        ':' becomes '_' as well, Prometheus keeps it for metric names
+     */
+    template <typename Accumulator>
+    void Add(const char *name, const Accumulator &acc, labels_t labels = {}) {
+        Series s;
+        s.source = &acc;
+        s.capture = &CaptureFrom<Accumulator>;
+        s.family = Family(name);
+
+        // both label forms are formatted once, here
+        std::string prom, json = "{";
+        for (auto &l : labels) {
+            prom += prom.empty() ? "{" : ",";
+            prom += Sanitize(l.first, false);
+            prom += "=\"";
+            prom += EscapeProm(l.second);
+            prom += "\"";
+            if (json.size() > 1) {
+                json += ",";
+            }
+            json += "\"" + EscapeJson(l.first) + "\":\"" + EscapeJson(l.second) + "\"";
+        }
+        if (!prom.empty()) {
+            prom += "}";
+        }
+        s.promLabels = prom;
+        s.jsonPrefix = "{\"name\":\"" + _families[s.family].name + "\",\"labels\":" + json + "},";
+        _families[s.family].series.push_back(_series.size());
+        _series.push_back(s);
+        _snap.push_back(MetricSnapshot());
+    }
+
+    /**
+     * @brief Snapshot phase: read every series into the capture table, under
+     *        the writers' mutex if the exporter has one
+     */
+    void Capture() {
+        std::unique_lock<std::mutex> lock;
+        if (_writers) {
+            lock = std::unique_lock<std::mutex>(*_writers);
+        }
+        for (size_t i = 0; i < _series.size(); i++) {
+            _series[i].capture(_series[i].source, _snap[i]);
+        }
+    }
+
+    /**
+     * @brief Format the last Capture() in Prometheus text exposition format
+     * @return Length of the complete output, excluding the terminating NUL
+     */
+    size_t RenderPrometheus(char *buf, size_t size) const {
+        Writer w(buf, size);
+        for (const auto &f : _families) {
+            w.put("# TYPE ");
+            w.put(f.name);
+            w.put(" summary\n");
+            for (size_t i : f.series) {
+                Line(w, f.name, "_count", _series[i].promLabels);
+                w.num(_snap[i].count);
+                w.put("\n");
+            }
+            for (size_t i : f.series) {
+                Line(w, f.name, "_sum", _series[i].promLabels);
+                w.num(_snap[i].mean * double(_snap[i].count));
+                w.put("\n");
+            }
+            Gauge(w, f, "_mean", false);
+            Gauge(w, f, "_stddev", true);
+        }
+        return w.finish();
+    }
+
+    /**
+     * @brief Format the last Capture() as one compact JSON document
+     * @return Length of the complete output, excluding the terminating NUL
+     */
+    size_t RenderJson(char *buf, size_t size) const {
+        Writer w(buf, size);
+        w.put("{\"metrics\":[");
+        for (size_t i = 0; i < _series.size(); i++) {
+            const MetricSnapshot &m = _snap[i];
+            if (i) {
+                w.put(",");
+            }
+            w.put(_series[i].jsonPrefix);
+            w.put("\"count\":");
+            w.num(m.count);
+            w.put(",\"mean\":");
+            w.json(m.mean);
+            w.put(",\"stddev\":");
+            w.json(sqrt(m.variance));
+            w.put("}");
+        }
+        w.put("]}\n");
+        return w.finish();
+    }
+
+    size_t Size() const {
+        return _series.size();
+    }
+
+    /**
+     * @brief The captured values of series i, in registration order
+     */
+    const MetricSnapshot &Captured(size_t i) const {
+        return _snap[i];
+    }
+
+  private:
+    struct Series {
+        const void *source;
+        void (*capture)(const void *, MetricSnapshot &);
+        size_t family;
+        std::string promLabels, jsonPrefix;
+    };
+
+    struct MetricFamily {
+        std::string name;
+        std::vector<size_t> series;
+    };
+
+    // bounded appender, counts what did not fit
+    struct Writer {
+        char *p, *end;
+        size_t n;
+        bool terminate;
+
+        Writer(char *buf, size_t size) : p(buf), end(size ? buf + size - 1 : buf), n(0), terminate(size > 0) {}
+
+        void put(const char *s, size_t len) {
+            size_t room = size_t(end - p);
+            size_t k = len < room ? len : room;
+            memcpy(p, s, k);
+            p += k;
+            n += len;
+        }
+        void put(const char *s) {
+            put(s, strlen(s));
+        }
+        void put(const std::string &s) {
+            put(s.data(), s.size());
+        }
+        void num(uint64_t v) {
+            char tmp[24];
+            put(tmp, size_t(std::to_chars(tmp, tmp + sizeof(tmp), v).ptr - tmp));
+        }
+        void num(double v) {
+            if (isnan(v)) {
+                put("NaN");
+            } else if (isinf(v)) {
+                put(v > 0 ? "+Inf" : "-Inf");
+            } else {
+                char tmp[32];
+                put(tmp, size_t(std::to_chars(tmp, tmp + sizeof(tmp), v).ptr - tmp));
+            }
+        }
+        void json(double v) {
+            if (isfinite(v)) {
+                num(v);
+            } else {
+                put("null");
+            }
+        }
+        size_t finish() {
+            if (terminate) {
+                *p = 0;
+            }
+            return n;
+        }
+    };
+
+    template <typename Accumulator>
+    static void CaptureFrom(const void *source, MetricSnapshot &out) {
+        MetricCapture<Accumulator>::Capture(*static_cast<const Accumulator *>(source), out);
+    }
+
+    static void Line(Writer &w, const std::string &name, const char *suffix, const std::string &labels) {
+        w.put(name);
+        w.put(suffix);
+        w.put(labels);
+        w.put(" ");
+    }
+
+    void Gauge(Writer &w, const MetricFamily &f, const char *suffix, bool stddev) const {
+        w.put("# TYPE ");
+        w.put(f.name);
+        w.put(suffix);
+        w.put(" gauge\n");
+        for (size_t i : f.series) {
+            Line(w, f.name, suffix, _series[i].promLabels);
+            w.num(stddev ? sqrt(_snap[i].variance) : _snap[i].mean);
+            w.put("\n");
+        }
+    }
+
+    size_t Family(const char *name) {
+        std::string n = Sanitize(name);
+        for (size_t i = 0; i < _families.size(); i++) {
+            if (_families[i].name == n) {
+                return i;
+            }
+        }
+        _families.push_back(MetricFamily{n, {}});
+        return _families.size() - 1;
+    }
+
+    // metric names allow ':', label names do not
+    static std::string Sanitize(const char *s, bool metric = true) {
+        std::string out(s);
+        for (size_t i = 0; i < out.size(); i++) {
+            char c = out[i];
+            bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (metric && c == ':') ||
+                      (i > 0 && c >= '0' && c <= '9');
+            if (!ok) {
+                out[i] = '_';
+            }
+        }
+        return out;
+    }
+
+    // Prometheus label values escape only backslash, quote and line feed
+    static std::string EscapeProm(const char *s) {
+        std::string out;
+        for (; *s; s++) {
+            if (*s == '\\' || *s == '"') {
+                out += '\\';
+                out += *s;
+            } else if (*s == '\n') {
+                out += "\\n";
+            } else {
+                out += *s;
+            }
+        }
+        return out;
+    }
+
+    // JSON strings also need every other control character escaped
+    static std::string EscapeJson(const char *s) {
+        static const char hex[] = "0123456789abcdef";
+        std::string out;
+        for (; *s; s++) {
+            unsigned char c = static_cast<unsigned char>(*s);
+            if (c == '\\' || c == '"') {
+                out += '\\';
+                out += *s;
+            } else if (c == '\n') {
+                out += "\\n";
+            } else if (c < 0x20) {
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 15];
+            } else {
+                out += *s;
+            }
+        }
+        return out;
+    }
+
+    std::vector<Series> _series;
+    std::vector<MetricFamily> _families;
+    std::vector<MetricSnapshot> _snap;
+    std::mutex *_writers;
+};
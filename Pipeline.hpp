@@ -0,0 +1,135 @@
+#pragma once
+
+// compile-time composition of per-sample processing stages
+//
+// auto p = pipe(Smooth(0.2), RollingVar<64>(), Above(0.5), Stats());
+// p.Push(x);                   // one sample through all stages
+// p.Push(samples, n);          // batch, one fused loop
+// p.get<3>().Mean();           // stages are the underlying accumulators
+//
+// a stage is anything callable as bool(_float_t &x): it may replace x with
+// its output and returns false to stop the sample from reaching later stages.
+// stages are stored by value in a std::tuple and called directly, so the
+// compiler sees and inlines the whole chain - no virtuals, no intermediate
+// buffers. lambdas work as stages too.
+
+#include <stddef.h>
+#include <tuple>
+#include <utility>
+
+#include "ExponentialSmoothing.hpp"
+#include "RollingVariance.hpp"
+#include "RunningStats.hpp"
+
+/**
+ * @brief ExponentialSmoothing stage, outputs the smoothed value
+ */
+struct Smooth : ExponentialSmoothing {
+    explicit Smooth(_float_t alpha) : ExponentialSmoothing(alpha) {}
+
+    bool operator()(_float_t &x) {
+        x = ExponentialSmoothing::Smooth(x);
+        return true;
+    }
+};
+
+/**
+ * @brief RollingVariance stage over the last N samples, outputs the variance
+ */
+template <size_t N>
+struct RollingVar : RollingVariance<_float_t> {
+    RollingVar() : RollingVariance<_float_t>(N) {}
+
+    bool operator()(_float_t &x) {
+        Push(x);
+        x = Variance();
+        return true;
+    }
+};
+
+/**
+ * @brief Threshold stage, passes only samples above limit
+ */
+struct Above {
+    explicit Above(_float_t limit) : limit(limit) {}
+
+    bool operator()(_float_t &x) const {
+        return x > limit;
+    }
+
+    _float_t limit;
+};
+
+/**
+ * @brief Threshold stage, passes only samples below limit
+ */
+struct Below {
+    explicit Below(_float_t limit) : limit(limit) {}
+
+    bool operator()(_float_t &x) const {
+        return x < limit;
+    }
+
+    _float_t limit;
+};
+
+/**
+ * @brief RunningStats stage, accumulates and passes the sample on unchanged
+ */
+struct Stats : RunningStats {
+    bool operator()(_float_t &x) {
+        Push(x);
+        return true;
+    }
+};
+
+template <typename... Stages>
+class Pipeline {
+  public:
+    explicit Pipeline(Stages... stages) : _stages(stages...) {}
+
+    /**
+     * @brief Run one sample through the stages
+     * @return true if the sample passed all stages
+     */
+    bool Push(_float_t x) {
+        return Run(x, std::index_sequence_for<Stages...>());
+    }
+
+    /**
+     * @brief Run a batch of samples through the stages
+     * @return Number of samples which passed all stages
+     */
+    size_t Push(const _float_t *x, size_t n) {
+        size_t passed = 0;
+        for (size_t i = 0; i < n; i++) {
+            passed += Run(x[i], std::index_sequence_for<Stages...>());
+        }
+        return passed;
+    }
+
+    /**
+     * @brief Access stage I, e.g. to read results or change parameters
+     */
+    template <size_t I>
+    typename std::tuple_element<I, std::tuple<Stages...>>::type &get() {
+        return std::get<I>(_stages);
+    }
+
+  private:
+    template <size_t... I>
+    bool Run(_float_t x, std::index_sequence<I...>) {
+        // && short-circuits, so a stage returning false ends the chain
+        return (std::get<I>(_stages)(x) && ...);
+    }
+
+    std::tuple<Stages...> _stages;
+};
+
+/**
+ * @brief Build a Pipeline from stages, deducing the stage types
+ */
+template <typename... Stages>
+Pipeline<Stages...> pipe(Stages... stages) {
+    return Pipeline<Stages...>(stages...);
+}
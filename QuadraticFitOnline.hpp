@@ -1,17 +1,24 @@
 // grok conversation: https://grok.com/share/bGVnYWN5_7e91020c-652b-4ec1-ba92-9f6ceacd7440
 
+#pragma once
+
+#include <stddef.h>
 #include <Eigen/Dense>
 
+#include "RunningStats.hpp"
+
 class QuadraticFitOnline {
   private:
     Eigen::Vector3f beta;  // Coefficients [c, b, a]
     Eigen::Matrix3f P;     // Inverse covariance matrix
+    Eigen::Matrix3d info;  // P^-1, kept exactly in double for block updates
 
   public:
     // Constructor: Initialize beta to zero and P to a large diagonal matrix
     QuadraticFitOnline() {
         beta.setZero();
         P = 1e6 * Eigen::Matrix3f::Identity();
+        info = 1e-6 * Eigen::Matrix3d::Identity();
     }
 
     // Update the fit with a new data point (x, y)
@@ -36,6 +43,47 @@ class QuadraticFitOnline {
 
         // Update the covariance matrix P (symmetric update)
         P -= (Px * Px.transpose()) / scalar;
+
+        // and its inverse, a rank one addition
+        Eigen::Vector3d xd = x_vec.cast<double>();
+        info += xd * xd.transpose();
+    }
+
+    // Update the fit with a block of n points, the least squares solution n
+    // calls of update(x, y) converge to; the two differ by the float rounding
+    // the single updates accumulate in P. The block's information (power sums
+    // of x up to x^4 and of y, x*y, x^2*y, accumulated in double) is added to
+    // the double information matrix in one step, so P is never inverted:
+    //   info' = info + X^T X,  P' = info'^-1,  beta' = P' (info beta + X^T y)
+    // If residuals is given, the residuals of the updated fit over the block
+    // are pushed into it.
+    void update(const float *x, const float *y, size_t n, RunningStats *residuals = nullptr) {
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0, t0 = 0, t1 = 0, t2 = 0;
+        for (size_t i = 0; i < n; i++) {
+            double xi = x[i], xx = xi * xi, yi = y[i];
+            s1 += xi;
+            s2 += xx;
+            s3 += xx * xi;
+            s4 += xx * xx;
+            t0 += yi;
+            t1 += xi * yi;
+            t2 += xx * yi;
+        }
+        s0 = double(n);
+
+        Eigen::Matrix3d XtX;
+        XtX << s0, s1, s2,
+               s1, s2, s3,
+               s2, s3, s4;
+        Eigen::Vector3d rhs = info * beta.cast<double>() + Eigen::Vector3d(t0, t1, t2);
+        info += XtX;
+        Eigen::Matrix3d Pd = info.inverse();
+        beta = (Pd * rhs).cast<float>();
+        P = (0.5 * (Pd + Pd.transpose())).cast<float>();
+
+        if (residuals) {
+            this->residuals(x, y, n, *residuals);
+        }
     }
 
     // Get the current coefficients [c, b, a]
@@ -48,6 +96,22 @@ class QuadraticFitOnline {
         Eigen::Vector3f x_vec(1.0, x, x * x);
         return x_vec.dot(beta);
     }
+
+    // Predict n values at once, Horner form c + x (b + x a) on Eigen arrays
+    // so the evaluation runs in SIMD lanes
+    void predict(const float *x, float *out, size_t n) const {
+        Eigen::Map<const Eigen::ArrayXf> X(x, n);
+        Eigen::Map<Eigen::ArrayXf> Y(out, n);
+        Y = beta[0] + X * (beta[1] + X * beta[2]);
+    }
+
+    // Push the residuals y - predict(x) of n points into stats
+    void residuals(const float *x, const float *y, size_t n, RunningStats &stats) const {
+        const float c = beta[0], b = beta[1], a = beta[2];
+        for (size_t i = 0; i < n; i++) {
+            stats.Push(y[i] - (c + x[i] * (b + x[i] * a)));
+        }
+    }
 };
 
 #if 0
@@ -0,0 +1,385 @@
+#pragma once
+
+// fixed-size random samples of an unbounded stream, e.g. for histograms,
+// medians or scatter plots over everything seen so far
+//
+// Reservoir         - uniform: every item seen is in the sample with the same
+//                     probability k / n (Li's Algorithm L)
+// DecayingReservoir - weighted by forward decay exp(alpha * (t - landmark)),
+//                     so recent items are more likely to be in the sample
+//                     (Efraimidis-Spirakis keys with exponential jumps)
+//
+// Reservoir<float> r(1000);
+// r.Push(samples, n);                  // batch: skips ahead without touching most items
+// for (float x : r.Samples()) ...
+// Reservoir<float> all = shard0 + shard1;  // per-thread reservoirs
+//
+// both draw a random number only for the items that enter the sample, about
+// k * (1 + log(n / k)) times for n items, and never allocate after the
+// constructor (merging builds a new reservoir).
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+#include "CircularBuffer.hpp"
+#include "Hashing.hpp"
+
+// splitmix64 stream, uniform doubles in (0, 1)
+struct ReservoirRng {
+    uint64_t s;
+
+    explicit ReservoirRng(uint64_t seed) : s(seed) {}
+
+    uint64_t Next() {
+        s += 0x9E3779B97F4A7C15ULL;
+        return HashMix64(s);
+    }
+    double Uniform() {
+        return (double(Next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+    }
+    size_t Below(size_t n) {
+        size_t i = size_t(Uniform() * double(n));
+        return i < n ? i : n - 1;
+    }
+};
+
+template <typename T>
+class Reservoir {
+  public:
+    /**
+     * @brief Constructor for Reservoir
+     * @param k Sample size
+     * @param seed Random seed; use a different one per shard
+     */
+    Reservoir(size_t k, uint64_t seed = 1) : _k(k ? k : 1), _rng(seed) {
+        _items.reserve(_k);
+        Clear();
+    }
+
+    void Clear() {
+        _items.clear();
+        _n = 0;
+        _next = 0;
+        _w = 1;
+    }
+
+    /**
+     * @brief Offer one item to the sample
+     */
+    void Push(const T &x) {
+        bool filling = Filling();
+        _n++;
+        if (filling) {
+            Fill(x);
+        } else if (_n == _next) {
+            Replace(x);
+        }
+    }
+
+    /**
+     * @brief Offer a batch of items; once the sample is full only the items
+     *        selected are read
+     */
+    void Push(const T *x, size_t n) {
+        size_t i = 0;
+        for (; i < n && Filling(); i++) {
+            _n++;
+            Fill(x[i]);
+        }
+        uint64_t base = _n - i; // items seen before x[0]
+        while (!Filling() && _next - base <= n) {
+            _n = _next;
+            Replace(x[_next - base - 1]);
+        }
+        _n = base + n;
+    }
+
+    /**
+     * @brief Offer the contents of a CircularBuffer, oldest first
+     */
+    void Push(const CircularBuffer<T> &cb) {
+        for (const T &x : cb) {
+            Push(x);
+        }
+    }
+
+    /**
+     * @brief The sample, in no particular order
+     */
+    const std::vector<T> &Samples() const {
+        return _items;
+    }
+
+    const T &operator[](size_t i) const {
+        return _items[i];
+    }
+
+    size_t Size() const {
+        return _items.size();
+    }
+
+    size_t Capacity() const {
+        return _k;
+    }
+
+    /**
+     * @brief Number of items offered so far
+     */
+    uint64_t Seen() const {
+        return _n;
+    }
+
+    /**
+     * @brief Uniform sample of the union of both streams, with the capacity of a
+     *
+     * The split between the two is drawn from the stream counts. When both
+     * hold fewer than the capacity of a together, a side draws at most the
+     * items it holds, so a merge of a short stream with a sample of a long one
+     * can come out smaller than either; it samples on at that size. Otherwise
+     * a reservoir of smaller capacity can give no more than the Size() items
+     * it holds, so it may end up under-represented.
+     */
+    friend Reservoir operator+(const Reservoir &a, const Reservoir &b) {
+        Reservoir c(a._k, a._rng.s ^ HashMix64(b._rng.s));
+        c._n = a._n + b._n;
+        if (a._items.size() == a._n && b._items.size() == b._n && c._n <= c._k) {
+            // both hold their whole stream
+            c._items = a._items;
+            c._items.insert(c._items.end(), b._items.begin(), b._items.end());
+        } else if (a._items.size() + b._items.size() <= c._k) {
+            // draws from a side that holds no more are dropped
+            uint64_t ra = a._n, rb = b._n;
+            size_t ka = 0, kb = 0;
+            for (size_t i = 0; i < c._k && ra + rb; i++) {
+                if (c._rng.Uniform() * double(ra + rb) < double(ra)) {
+                    ra--;
+                    ka += ka < a._items.size();
+                } else {
+                    rb--;
+                    kb += kb < b._items.size();
+                }
+            }
+            c.TakeRandom(a._items, ka);
+            c.TakeRandom(b._items, kb);
+        } else {
+            // how many come from a: k draws without replacement from
+            // a._n + b._n items, a._n of them a's; a side whose stored items
+            // are used up passes the draw to the other
+            uint64_t ra = a._n, rb = b._n;
+            size_t ka = 0, kb = 0;
+            for (size_t i = 0; i < c._k; i++) {
+                bool fromA = c._rng.Uniform() * double(ra + rb) < double(ra);
+                if (fromA ? ka == a._items.size() : kb == b._items.size()) {
+                    fromA = !fromA;
+                }
+                if (fromA) {
+                    ra--;
+                    ka++;
+                } else {
+                    rb--;
+                    kb++;
+                }
+            }
+            c.TakeRandom(a._items, ka);
+            c.TakeRandom(b._items, kb);
+        }
+        if (!c.Filling()) {
+            c.Restart();
+        }
+        return c;
+    }
+
+    Reservoir &operator+=(const Reservoir &rhs) {
+        *this = *this + rhs;
+        return *this;
+    }
+
+  private:
+    // every item seen so far is in the sample and there is room for more;
+    // otherwise the sample is of Size() items, which is below the capacity
+    // only after a merge
+    bool Filling() const {
+        return _items.size() == _n && _items.size() < _k;
+    }
+
+    void Fill(const T &x) {
+        _items.push_back(x);
+        if (_items.size() == _k) {
+            _w = exp(log(_rng.Uniform()) / double(_k));
+            Skip();
+        }
+    }
+
+    void Replace(const T &x) {
+        size_t m = _items.size();
+        _items[_rng.Below(m)] = x;
+        _w *= exp(log(_rng.Uniform()) / double(m));
+        Skip();
+    }
+
+    // index of the next item to enter the sample
+    void Skip() {
+        double gap = floor(log(_rng.Uniform()) / log1p(-_w));
+        _next = _n + 1 + (gap < 1e18 ? uint64_t(gap) : uint64_t(1e18));
+    }
+
+    // the Algorithm L state of a sample of Size() items over _n: _w is the
+    // Size()-th smallest of _n uniform keys, built up one order statistic at
+    // a time
+    void Restart() {
+        double x = 0;
+        for (size_t j = 0; j < _items.size(); j++) {
+            x = 1 - (1 - x) * exp(log(_rng.Uniform()) / double(_n - j));
+        }
+        _w = x;
+        Skip();
+    }
+
+    void TakeRandom(const std::vector<T> &from, size_t m) {
+        std::vector<size_t> idx(from.size());
+        for (size_t i = 0; i < idx.size(); i++) {
+            idx[i] = i;
+        }
+        for (size_t i = 0; i < m; i++) {
+            std::swap(idx[i], idx[i + _rng.Below(idx.size() - i)]);
+            _items.push_back(from[idx[i]]);
+        }
+    }
+
+    size_t _k;
+    std::vector<T> _items;
+    uint64_t _n, _next;
+    double _w;
+    ReservoirRng _rng;
+};
+
+template <typename T>
+class DecayingReservoir {
+  public:
+    /**
+     * @brief Constructor for DecayingReservoir
+     * @param k Sample size
+     * @param alpha Decay rate per timestamp unit; an item of age a is
+     *        exp(-alpha * a) times as likely to be kept as a new one
+     * @param landmark Timestamp the weights are relative to; reservoirs to be
+     *        merged need the same alpha and landmark
+     * @param seed Random seed; use a different one per shard
+     */
+    DecayingReservoir(size_t k, double alpha, uint64_t landmark = 0, uint64_t seed = 1)
+        : _k(k ? k : 1), _alpha(alpha), _landmark(landmark), _rng(seed) {
+        _heap.reserve(_k);
+        Clear();
+    }
+
+    void Clear() {
+        _heap.clear();
+        _n = 0;
+        _jump = 0;
+    }
+
+    /**
+     * @brief Offer one timestamped item
+     */
+    void Push(uint64_t t, const T &x) {
+        _n++;
+        // log weight; keys are log(E) - log(weight), E ~ Exp(1), smallest k kept
+        double lw = _alpha * double(int64_t(t - _landmark));
+        if (_heap.size() < _k) {
+            _heap.push_back(Slot{log(-log(_rng.Uniform())) - lw, x});
+            std::push_heap(_heap.begin(), _heap.end(), KeyLess);
+            if (_heap.size() == _k) {
+                _jump = -log(_rng.Uniform());
+            }
+            return;
+        }
+        // the item enters iff E < exp(threshold + lw); the skipped items'
+        // rates add up until an Exp(1) variable is used up
+        double rate = exp(_heap.front().key + lw);
+        _jump -= rate;
+        if (_jump > 0) {
+            return;
+        }
+        double e = -log1p(_rng.Uniform() * expm1(-rate)); // E given E < rate
+        std::pop_heap(_heap.begin(), _heap.end(), KeyLess);
+        _heap.back() = Slot{log(e) - lw, x};
+        std::push_heap(_heap.begin(), _heap.end(), KeyLess);
+        _jump = -log(_rng.Uniform());
+    }
+
+    /**
+     * @brief Offer a batch of timestamped items
+     */
+    void Push(const uint64_t *t, const T *x, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            Push(t[i], x[i]);
+        }
+    }
+
+    const T &operator[](size_t i) const {
+        return _heap[i].item;
+    }
+
+    /**
+     * @brief Call fn(item) for every item in the sample
+     */
+    template <typename Fn>
+    void ForEach(Fn fn) const {
+        for (const Slot &s : _heap) {
+            fn(s.item);
+        }
+    }
+
+    size_t Size() const {
+        return _heap.size();
+    }
+
+    size_t Capacity() const {
+        return _k;
+    }
+
+    uint64_t Seen() const {
+        return _n;
+    }
+
+    /**
+     * @brief Weighted sample of the union of both streams: the k smallest keys
+     */
+    friend DecayingReservoir operator+(const DecayingReservoir &a, const DecayingReservoir &b) {
+        DecayingReservoir c(a._k, a._alpha, a._landmark, a._rng.s ^ HashMix64(b._rng.s));
+        std::vector<Slot> all(a._heap);
+        all.insert(all.end(), b._heap.begin(), b._heap.end());
+        size_t keep = std::min(all.size(), c._k);
+        std::partial_sort(all.begin(), all.begin() + keep, all.end(), KeyLess);
+        c._heap.assign(all.begin(), all.begin() + keep);
+        std::make_heap(c._heap.begin(), c._heap.end(), KeyLess);
+        c._n = a._n + b._n;
+        c._jump = c._heap.size() == c._k ? -log(c._rng.Uniform()) : 0;
+        return c;
+    }
+
+    DecayingReservoir &operator+=(const DecayingReservoir &rhs) {
+        *this = *this + rhs;
+        return *this;
+    }
+
+  private:
+    struct Slot {
+        double key;
+        T item;
+    };
+
+    // max-heap on key: the front is the next to go
+    static bool KeyLess(const Slot &x, const Slot &y) {
+        return x.key < y.key;
+    }
+
+    size_t _k;
+    double _alpha;
+    uint64_t _landmark;
+    std::vector<Slot> _heap;
+    uint64_t _n;
+    double _jump; // rate left before the next item enters
+    ReservoirRng _rng;
+};
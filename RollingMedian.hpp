@@ -0,0 +1,237 @@
+#pragma once
+
+// median of the last W samples in O(log W) per sample
+//
+// the window is split into a max-heap (lower half) and a min-heap (upper half)
+// of slot indices, with a position index per slot. once the window is full the
+// oldest sample's slot is overwritten in place and re-sifted inside its heap,
+// so there is no lazy deletion and no allocation after construction.
+
+#include <stdint.h>
+#include <math.h>
+#include <limits>
+#include <vector>
+
+#include "RollingVariance.hpp"
+
+template <typename T>
+class RollingMedian {
+  public:
+    /**
+     * @brief Constructor for RollingMedian
+     * @param window_size Number of samples the median is taken over
+     */
+    RollingMedian(size_t window_size)
+        : _window_size(window_size), _values(window_size), _where(window_size),
+          _lo(window_size / 2 + 1), _hi(window_size / 2 + 1) {
+        Clear();
+    }
+
+    /**
+     * @brief Reset the instance to its initial state
+     */
+    void Clear() {
+        _count = _next = _nlo = _nhi = 0;
+    }
+
+    /**
+     * @brief Add a new value, replacing the oldest once the window is full
+     * @param x The new value to add
+     */
+    void Push(T x) {
+        uint32_t slot = _next;
+        _next = (_next + 1 == _window_size) ? 0 : _next + 1;
+        _values[slot] = x;
+
+        if (_count < _window_size) {
+            _count++;
+            if (_nlo == 0 || x <= _values[_lo[0]]) {
+                Place(_lo.data(), _nlo, slot, false);
+                SiftUp<true>(_lo.data(), _nlo++);
+            } else {
+                Place(_hi.data(), _nhi, slot, true);
+                SiftUp<false>(_hi.data(), _nhi++);
+            }
+            // keep _nlo == _nhi or _nlo == _nhi + 1
+            if (_nlo > _nhi + 1) {
+                uint32_t top = _lo[0];
+                Place(_lo.data(), 0, _lo[--_nlo], false);
+                SiftDown<true>(_lo.data(), _nlo, 0);
+                Place(_hi.data(), _nhi, top, true);
+                SiftUp<false>(_hi.data(), _nhi++);
+            } else if (_nhi > _nlo) {
+                uint32_t top = _hi[0];
+                Place(_hi.data(), 0, _hi[--_nhi], true);
+                SiftDown<false>(_hi.data(), _nhi, 0);
+                Place(_lo.data(), _nlo, top, false);
+                SiftUp<true>(_lo.data(), _nlo++);
+            }
+            return;
+        }
+
+        // window full: the slot keeps its heap position, restore heap order
+        int32_t w = _where[slot];
+        if (w >= 0) {
+            SiftDown<true>(_lo.data(), _nlo, SiftUp<true>(_lo.data(), w));
+        } else {
+            SiftDown<false>(_hi.data(), _nhi, SiftUp<false>(_hi.data(), ~w));
+        }
+        // the new value may now belong to the other half
+        if (_nhi && _values[_lo[0]] > _values[_hi[0]]) {
+            uint32_t a = _lo[0], b = _hi[0];
+            Place(_lo.data(), 0, b, false);
+            Place(_hi.data(), 0, a, true);
+            SiftDown<true>(_lo.data(), _nlo, 0);
+            SiftDown<false>(_hi.data(), _nhi, 0);
+        }
+    }
+
+    /**
+     * @brief Get the median of the current window
+     * @return The median, mean of the two middle values for an even count
+     */
+    T Median() const {
+        if (_count == 0) {
+            return std::numeric_limits<T>::quiet_NaN();
+        }
+        if (_nlo > _nhi) {
+            return _values[_lo[0]];
+        }
+        return (_values[_lo[0]] + _values[_hi[0]]) / static_cast<T>(2);
+    }
+
+    /**
+     * @brief Get the number of values currently in the window
+     */
+    size_t size() const {
+        return _count;
+    }
+
+    bool isFull() const {
+        return _count == _window_size;
+    }
+
+    /**
+     * @brief Get the window size
+     * @return The size of the window
+     */
+    size_t getWindowSize() const {
+        return _window_size;
+    }
+
+  private:
+    // heap entry i of lo is encoded as i, of hi as ~i
+    void Place(uint32_t *heap, size_t i, uint32_t slot, bool hi) {
+        heap[i] = slot;
+        _where[slot] = hi ? ~int32_t(i) : int32_t(i);
+    }
+
+    template <bool Max>
+    bool Above(uint32_t a, uint32_t b) const {
+        return Max ? _values[a] > _values[b] : _values[a] < _values[b];
+    }
+
+    template <bool Max>
+    size_t SiftUp(uint32_t *heap, size_t i) {
+        uint32_t slot = heap[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (!Above<Max>(slot, heap[parent])) {
+                break;
+            }
+            Place(heap, i, heap[parent], !Max);
+            i = parent;
+        }
+        Place(heap, i, slot, !Max);
+        return i;
+    }
+
+    template <bool Max>
+    void SiftDown(uint32_t *heap, size_t n, size_t i) {
+        uint32_t slot = heap[i];
+        for (;;) {
+            size_t child = 2 * i + 1;
+            if (child >= n) {
+                break;
+            }
+            if (child + 1 < n && Above<Max>(heap[child + 1], heap[child])) {
+                child++;
+            }
+            if (!Above<Max>(heap[child], slot)) {
+                break;
+            }
+            Place(heap, i, heap[child], !Max);
+            i = child;
+        }
+        Place(heap, i, slot, !Max);
+    }
+
+    size_t _window_size, _count, _next, _nlo, _nhi;
+    std::vector<T> _values;
+    std::vector<int32_t> _where;
+    std::vector<uint32_t> _lo, _hi;
+};
+
+// Hampel-style spike filter: a sample further than k standard deviations from
+// the rolling median is replaced by the median. The deviation is tracked with
+// a RollingVariance over the filter's own output, so rejected spikes do not
+// inflate it. While the window fills, samples pass through unchanged.
+template <typename T>
+class HampelFilter {
+  public:
+    /**
+     * @brief Constructor for HampelFilter
+     * @param window_size Window of the median and the deviation estimate
+     * @param k Rejection threshold in standard deviations
+     */
+    HampelFilter(size_t window_size, T k = static_cast<T>(3.0))
+        : _median(window_size), _scale(window_size), _k(k), _outlier(false) {}
+
+    void Clear() {
+        _median.Clear();
+        _scale.Clear();
+        _outlier = false;
+    }
+
+    /**
+     * @brief Filter one sample
+     * @return The sample, or the rolling median if it was rejected
+     */
+    T Push(T x) {
+        if (_median.size() == 0) {
+            _scale.Prime(x);
+        }
+        bool warm = _median.isFull();
+        _median.Push(x);
+        T m = _median.Median();
+        T y = x;
+        _outlier = false;
+        if (warm) {
+            T d = x - m;
+            T limit = _k * static_cast<T>(sqrt(_scale.Variance()));
+            if (d > limit || -d > limit) {
+                y = m;
+                _outlier = true;
+            }
+        }
+        _scale.Push(y);
+        return y;
+    }
+
+    /**
+     * @brief Whether the last pushed sample was rejected
+     */
+    bool Outlier() const {
+        return _outlier;
+    }
+
+    T Median() const {
+        return _median.Median();
+    }
+
+  private:
+    RollingMedian<T> _median;
+    RollingVariance<T> _scale;
+    T _k;
+    bool _outlier;
+};
@@ -4,13 +4,22 @@
 // based upon https://stackoverflow.com/questions/5147378/rolling-variance-algorithm/74239458#74239458
 
 #include <vector>
+#include <algorithm>
 
-template <typename T>
+#include "rstypes.h"
+
+// Mode selects RS_SHIFTED and/or RS_COMPENSATED accumulation, see rstypes.h.
+// When shifted, the window is primed with the first sample pushed rather
+// than with zeros.
+template <typename T, int Mode = RS_ACCUMULATE>
 class RollingVariance {
   private:
     std::vector<T> _samples;
-    T _mean, _var_sum;
     size_t _window_size, _i;
+    T _mean, _var_sum;
+    T _ref;           // RS_SHIFTED: samples are stored as x - _ref
+    T _cmean, _cvar;  // RS_COMPENSATED: Kahan compensation of _mean, _var_sum
+    bool _primed;
 
   public:
     /**
@@ -18,8 +27,9 @@ class RollingVariance {
      * @param window_size The size of the window for variance calculation
      */
     RollingVariance(size_t window_size)
-        : _window_size(window_size), _i(0), _mean(static_cast<T>(0.0)), _var_sum(static_cast<T>(0.0)) {
+        : _window_size(window_size), _i(0) {
         _samples.resize(_window_size, static_cast<T>(0.0));
+        Clear();
     }
 
     /**
@@ -29,6 +39,8 @@ class RollingVariance {
         _i = 0;
         _mean = static_cast<T>(0.0);
         _var_sum = static_cast<T>(0.0);
+        _ref = _cmean = _cvar = static_cast<T>(0.0);
+        _primed = false;
         std::fill(_samples.begin(), _samples.end(), static_cast<T>(0.0));
     }
 
@@ -37,9 +49,18 @@ class RollingVariance {
     * @param value The value to fill the window with
     */
     void Prime(T value) {
-        std::fill(_samples.begin(), _samples.end(), value);
         _i = 0; // Reset index to start (though it doesn't affect variance/mean here)
-        _mean = value; // Mean is the value itself since all elements are identical
+        _cmean = _cvar = static_cast<T>(0.0);
+        _primed = true;
+        if (Mode & RS_SHIFTED) {
+            // value becomes the reference, the window holds its offsets
+            _ref = value;
+            std::fill(_samples.begin(), _samples.end(), static_cast<T>(0.0));
+            _mean = static_cast<T>(0.0);
+        } else {
+            std::fill(_samples.begin(), _samples.end(), value);
+            _mean = value; // Mean is the value itself since all elements are identical
+        }
         _var_sum = static_cast<T>(0.0); // Variance of identical values is 0
     }
 
@@ -48,13 +69,26 @@ class RollingVariance {
      * @param x_new The new value to add
      */
     void Push(T x_new) {
+        if (Mode & RS_SHIFTED) {
+            if (!_primed) {
+                Prime(x_new);
+            }
+            x_new -= _ref;
+        }
         _i = (_i + 1) % _window_size;
         T x_old = _samples[_i];
         T dx = x_new - x_old;  // oldest x
-        T new_mean = _mean + dx / static_cast<T>(_window_size); // new mean
+        T mean = (Mode & RS_COMPENSATED) ? _mean - _cmean : _mean;
+        T dmean = dx / static_cast<T>(_window_size);
+        T new_mean = mean + dmean; // new mean
 
-        _var_sum += ((x_new + x_old - _mean - new_mean) * dx);
-        _mean = new_mean;
+        if (Mode & RS_COMPENSATED) {
+            rs_kahan_add(_var_sum, _cvar, (x_new + x_old - mean - new_mean) * dx);
+            rs_kahan_add(_mean, _cmean, dmean);
+        } else {
+            _var_sum += ((x_new + x_old - mean - new_mean) * dx);
+            _mean = new_mean;
+        }
         _samples[_i] = x_new;
     }
 
@@ -63,7 +97,8 @@ class RollingVariance {
      * @return The variance
      */
     T Variance() const {
-        return _var_sum / static_cast<T>(_window_size);
+        T var_sum = (Mode & RS_COMPENSATED) ? _var_sum - _cvar : _var_sum;
+        return var_sum / static_cast<T>(_window_size);
     }
 
     /**
@@ -71,7 +106,8 @@ class RollingVariance {
      * @return The mean value
      */
     T Mean() const {
-        return _mean;
+        T mean = (Mode & RS_COMPENSATED) ? _mean - _cmean : _mean;
+        return (Mode & RS_SHIFTED) ? mean + _ref : mean;
     }
 
     /**
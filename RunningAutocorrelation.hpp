@@ -0,0 +1,301 @@
+#pragma once
+
+// autocovariance / autocorrelation for lags 0..L of a stream, O(L) per sample
+//
+// RunningAutocorrelation<float> ac(64);
+// ac.Push(x);
+// float r = ac.Autocorrelation(12);    // periodicity at lag 12?
+//
+// the cross-products x[i] * x[i-k] are accumulated for every lag. The last L
+// samples live in a mirrored delay line (each sample written twice, L apart),
+// so the lags of a new sample are one contiguous slice and the update loop
+// vectorizes. Samples are shifted by the first one to keep the products small.
+// The first L samples are kept as well, which makes the estimate exact (no
+// end effects) and lets operator+ join two consecutive segments, e.g. blocks
+// processed by different threads.
+//
+// PushBlock() adds a whole block via FFT, O(n log n + L^2) instead of O(n L),
+// which pays off for large L and blocks of at least L samples.
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stddef.h>
+#include <vector>
+
+#include "CircularBuffer.hpp"
+
+template <typename T>
+class RunningAutocorrelation {
+  public:
+    /**
+     * @brief Constructor for RunningAutocorrelation
+     * @param max_lag Largest lag L tracked
+     */
+    RunningAutocorrelation(size_t max_lag)
+        : _lags(max_lag), _s(max_lag + 1), _head(max_lag), _line(2 * max_lag) {
+        Clear();
+    }
+
+    /**
+     * @brief Reset all statistics to initial state
+     */
+    void Clear() {
+        _n = 0;
+        _pos = 0;
+        _k = _sum = static_cast<T>(0);
+        std::fill(_s.begin(), _s.end(), static_cast<T>(0));
+        std::fill(_head.begin(), _head.end(), static_cast<T>(0));
+        std::fill(_line.begin(), _line.end(), static_cast<T>(0));
+    }
+
+    /**
+     * @brief Add a new value
+     * @param x The value to add
+     */
+    void Push(T x) {
+        if (_n == 0) {
+            _k = x;
+        }
+        T y = x - _k;
+        // h[k - 1] is the sample k back, zero before the stream started
+        const T *__restrict h = _line.data() + _pos;
+        T *__restrict s = _s.data() + 1;
+        for (size_t k = 0; k < _lags; k++) {
+            s[k] += y * h[k];
+        }
+        _s[0] += y * y;
+        _sum += y;
+        if (_n < _lags) {
+            _head[_n] = y;
+        }
+        if (_lags) {
+            _pos = _pos ? _pos - 1 : _lags - 1;
+            _line[_pos] = _line[_pos + _lags] = y;
+        }
+        _n++;
+    }
+
+    /**
+     * @brief Add a batch of values
+     */
+    void Push(const T *x, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            Push(x[i]);
+        }
+    }
+
+    /**
+     * @brief Add the contents of a CircularBuffer, oldest first
+     */
+    void Push(const CircularBuffer<T> &cb) {
+        for (T x : cb) {
+            Push(x);
+        }
+    }
+
+    /**
+     * @brief Add a block of values, cross-products via FFT
+     */
+    void PushBlock(const T *x, size_t n) {
+        if (n == 0) {
+            return;
+        }
+        RunningAutocorrelation block(_lags);
+        block._k = x[0];
+        block._n = n;
+        size_t size = 1;
+        while (size < 2 * n) {
+            size <<= 1;
+        }
+        _fft.assign(size, std::complex<T>(0));
+        for (size_t i = 0; i < n; i++) {
+            T y = x[i] - block._k;
+            _fft[i] = y;
+            block._sum += y;
+            if (i < _lags) {
+                block._head[i] = y;
+            }
+            if (n - 1 - i < _lags) {
+                size_t m = n - 1 - i;
+                block._line[m] = block._line[m + _lags] = y;
+            }
+        }
+        // |FFT|^2 is the transform of the autocorrelation, zero padding
+        // to 2n keeps it from wrapping around
+        Transform(false);
+        for (auto &c : _fft) {
+            c = std::norm(c);
+        }
+        Transform(true);
+        for (size_t k = 0; k <= _lags && k < n; k++) {
+            block._s[k] = _fft[k].real() / static_cast<T>(size);
+        }
+        *this += block;
+    }
+
+    /**
+     * @brief Get the number of values added
+     */
+    size_t NumDataValues() const {
+        return _n;
+    }
+
+    size_t MaxLag() const {
+        return _lags;
+    }
+
+    T Mean() const {
+        return _n ? _k + _sum / static_cast<T>(_n) : static_cast<T>(0);
+    }
+
+    /**
+     * @brief Autocovariance at one lag, 1/n normalized
+     * @param lag 0..MaxLag(), lag 0 is the population variance
+     */
+    T Autocovariance(size_t lag) const {
+        if (lag > _lags || lag >= _n) {
+            return static_cast<T>(0);
+        }
+        T first = 0, last = 0;
+        for (size_t i = 0; i < lag; i++) {
+            first += _head[i];
+            last += _line[_pos + i];
+        }
+        return Covariance(lag, first, last);
+    }
+
+    /**
+     * @brief Autocovariance at all lags 0..MaxLag() in one O(L) pass
+     * @param out MaxLag() + 1 values
+     */
+    void Autocovariances(T *out) const {
+        T first = 0, last = 0;
+        for (size_t k = 0; k <= _lags; k++) {
+            out[k] = k < _n ? Covariance(k, first, last) : static_cast<T>(0);
+            if (k < _lags) {
+                first += _head[k];
+                last += _line[_pos + k];
+            }
+        }
+    }
+
+    /**
+     * @brief Autocorrelation at one lag, in -1..1
+     */
+    T Autocorrelation(size_t lag) const {
+        T c0 = Autocovariance(0);
+        return c0 > 0 ? Autocovariance(lag) / c0 : static_cast<T>(0);
+    }
+
+    /**
+     * @brief Autocorrelation at all lags 0..MaxLag()
+     * @param out MaxLag() + 1 values
+     */
+    void Autocorrelations(T *out) const {
+        Autocovariances(out);
+        T c0 = out[0];
+        for (size_t k = 0; k <= _lags; k++) {
+            out[k] = c0 > 0 ? out[k] / c0 : static_cast<T>(0);
+        }
+    }
+
+    /**
+     * @brief Join two consecutive segments of one stream, a before b
+     * @note both must track the same number of lags
+     */
+    friend RunningAutocorrelation operator+(const RunningAutocorrelation &a, const RunningAutocorrelation &b) {
+        if (b._n == 0) {
+            return a;
+        }
+        if (a._n == 0) {
+            return b;
+        }
+        size_t L = a._lags;
+        RunningAutocorrelation c(L);
+        c._k = a._k;
+        c._n = a._n + b._n;
+        // b's samples relative to a's shift are y + e
+        T e = b._k - a._k;
+        T nb = static_cast<T>(b._n);
+        c._sum = a._sum + b._sum + nb * e;
+
+        T first = 0, last = 0; // of b's first / last k samples
+        for (size_t k = 0; k <= L; k++) {
+            T s = a._s[k];
+            if (k < b._n) {
+                T pairs = static_cast<T>(b._n - k);
+                s += b._s[k] + e * ((b._sum - first) + (b._sum - last)) + pairs * e * e;
+            }
+            // pairs straddling the boundary: b's j-th with a's (k - j)-th last
+            for (size_t j = 0; j < k && j < b._n && j < L; j++) {
+                s += (b._head[j] + e) * a._line[a._pos + k - j - 1];
+            }
+            c._s[k] = s;
+            if (k < L) {
+                first += b._head[k];
+                last += b._line[b._pos + k];
+            }
+        }
+
+        size_t na = a._n < L ? a._n : L;
+        for (size_t i = 0; i < L; i++) {
+            c._head[i] = i < na ? a._head[i] : (i - na < b._n ? b._head[i - na] + e : static_cast<T>(0));
+            T y = i < b._n ? b._line[b._pos + i] + e : a._line[a._pos + i - b._n];
+            c._line[i] = c._line[i + L] = y;
+        }
+        return c;
+    }
+
+    RunningAutocorrelation &operator+=(const RunningAutocorrelation &rhs) {
+        std::vector<std::complex<T>> scratch;
+        scratch.swap(_fft);
+        *this = *this + rhs;
+        _fft.swap(scratch);
+        return *this;
+    }
+
+  private:
+    // lag k autocovariance given the sums of the first and last k samples
+    T Covariance(size_t k, T first, T last) const {
+        T n = static_cast<T>(_n);
+        T m = _sum / n;
+        return (_s[k] - m * ((_sum - first) + (_sum - last)) + static_cast<T>(_n - k) * m * m) / n;
+    }
+
+    // in-place radix-2 FFT of _fft, unscaled
+    void Transform(bool inverse) {
+        size_t n = _fft.size();
+        for (size_t i = 1, j = 0; i < n; i++) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j) {
+                std::swap(_fft[i], _fft[j]);
+            }
+        }
+        const double pi = 3.14159265358979323846;
+        for (size_t len = 2; len <= n; len <<= 1) {
+            double a = (inverse ? 2 : -2) * pi / len;
+            std::complex<T> w(static_cast<T>(cos(a)), static_cast<T>(sin(a)));
+            for (size_t i = 0; i < n; i += len) {
+                std::complex<T> wk(1);
+                for (size_t j = 0; j < len / 2; j++) {
+                    std::complex<T> u = _fft[i + j], v = _fft[i + j + len / 2] * wk;
+                    _fft[i + j] = u + v;
+                    _fft[i + j + len / 2] = u - v;
+                    wk *= w;
+                }
+            }
+        }
+    }
+
+    size_t _lags, _n, _pos;
+    T _k, _sum;                  // shift (first sample), sum of x - _k
+    std::vector<T> _s;           // _s[k]: sum of (x[i] - _k)(x[i-k] - _k)
+    std::vector<T> _head;        // first L samples, shifted
+    std::vector<T> _line;        // last L samples newest first, mirrored
+    std::vector<std::complex<T>> _fft; // PushBlock scratch
+};
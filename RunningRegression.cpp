@@ -35,6 +35,8 @@ _float_t RunningRegression::Correlation() const {
   return S_xy / ((n - 1) * t);
 }
 
+void RunningRegression::ShiftX(_float_t dx) { x_stats.Shift(dx); }
+
 RunningRegression operator+(const RunningRegression a,
                             const RunningRegression b) {
   RunningRegression combined;
@@ -46,7 +48,7 @@ RunningRegression operator+(const RunningRegression a,
   _float_t delta_x = b.x_stats.Mean() - a.x_stats.Mean();
   _float_t delta_y = b.y_stats.Mean() - a.y_stats.Mean();
   combined.S_xy = a.S_xy + b.S_xy +
-                  _float_t(a.n * b.n) * delta_x * delta_y / _float_t(combined.n);
+                  _float_t(a.n) * _float_t(b.n) * delta_x * delta_y / _float_t(combined.n);
 
   return combined;
 }
@@ -14,6 +14,8 @@ public:
   _float_t Slope() const;
   _float_t Intercept() const;
   _float_t Correlation() const;
+  // as if dx had been added to every x pushed so far, e.g. to renumber rows
+  void ShiftX(_float_t dx);
 
   friend RunningRegression operator+(const RunningRegression a,
                                      const RunningRegression b);
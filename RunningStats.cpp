@@ -13,41 +13,82 @@ RunningStats::RunningStats() { Clear(); }
 void RunningStats::Clear() {
   n = 0;
   M1 = M2 = M3 = M4 = 0.0;
+#if RS_ACCUMULATE & RS_SHIFTED
+  K = 0.0;
+#endif
+#if RS_ACCUMULATE & RS_COMPENSATED
+  cM1 = cM2 = 0.0;
+#endif
+}
+
+// M1, M2 including the Kahan compensation
+inline _float_t RunningStats::m1() const {
+#if RS_ACCUMULATE & RS_COMPENSATED
+  return M1 - cM1;
+#else
+  return M1;
+#endif
+}
+
+inline _float_t RunningStats::m2() const {
+#if RS_ACCUMULATE & RS_COMPENSATED
+  return M2 - cM2;
+#else
+  return M2;
+#endif
+}
+
+inline _float_t RunningStats::shift() const {
+#if RS_ACCUMULATE & RS_SHIFTED
+  return K;
+#else
+  return 0.0;
+#endif
 }
 
 void RunningStats::Push(_float_t x) {
   _float_t delta, delta_n, delta_n2, term1;
   _counter_t n1 = n;
+#if RS_ACCUMULATE & RS_SHIFTED
+  if (n == 0)
+    K = x;
+  x -= K;
+#endif
   n++;
-  delta = x - M1;
+  delta = x - m1();
   delta_n = delta / n;
   delta_n2 = delta_n * delta_n;
   term1 = delta * delta_n * n1;
-  M1 += delta_n;
-  M4 += term1 * delta_n2 * (n * n - 3 * n + 3) + 6 * delta_n2 * M2 -
+  M4 += term1 * delta_n2 * (n * n - 3 * n + 3) + 6 * delta_n2 * m2() -
         4 * delta_n * M3;
-  M3 += term1 * delta_n * (n - 2) - 3 * delta_n * M2;
+  M3 += term1 * delta_n * (n - 2) - 3 * delta_n * m2();
+#if RS_ACCUMULATE & RS_COMPENSATED
+  rs_kahan_add(M1, cM1, delta_n);
+  rs_kahan_add(M2, cM2, term1);
+#else
+  M1 += delta_n;
   M2 += term1;
+#endif
 }
 
 _counter_t RunningStats::NumDataValues() const { return n; }
 
-_float_t RunningStats::Mean() const { return M1; }
+_float_t RunningStats::Mean() const { return m1() + shift(); }
 
-_float_t RunningStats::Variance() const { return M2 / (n - 1.0); }
-_float_t RunningStats::PopulationVariance() const { return M2 / n; }
+_float_t RunningStats::Variance() const { return m2() / (n - 1.0); }
+_float_t RunningStats::PopulationVariance() const { return m2() / n; }
 
 _float_t RunningStats::StandardDeviation() const { return sqrt(Variance()); }
 
 _float_t RunningStats::Skewness() const {
-  return sqrt(_float_t(n)) * M3 / pow(M2, 1.5);
+  return sqrt(_float_t(n)) * M3 / pow(m2(), 1.5);
 }
 
 _float_t RunningStats::Kurtosis() const {
-  return _float_t(n) * M4 / (M2 * M2) - 3.0;
+  return _float_t(n) * M4 / (m2() * m2()) - 3.0;
 }
 
-_float_t RunningStats::ConfidenceInterval(ci_t ci) {
+_float_t RunningStats::ConfidenceInterval(ci_t ci) const {
   // if (n < 300)
   //   return NAN;
   // if (ci < CI90 || ci > CI99)
@@ -55,30 +96,71 @@ _float_t RunningStats::ConfidenceInterval(ci_t ci) {
   return z_values[ci] * StandardDeviation() / sqrt((_float_t)n);
 }
 
+void RunningStats::Shift(_float_t dx) {
+  // the moments above the mean are central and do not change
+#if RS_ACCUMULATE & RS_SHIFTED
+  K += dx;
+#else
+  M1 += dx;
+#endif
+}
+
+// one sqrt each for the standard deviation, sqrt(n) and sqrt(M2)
+RunningStatsSummary RunningStats::Summary() const {
+  RunningStatsSummary summary;
+  _float_t m2v = m2();
+  _float_t sn = sqrt(_float_t(n));
+  summary.n = n;
+  summary.mean = Mean();
+  summary.variance = m2v / (n - 1.0);
+  summary.stddev = sqrt(summary.variance);
+  summary.skewness = sn * M3 / (m2v * sqrt(m2v));
+  summary.kurtosis = _float_t(n) * M4 / (m2v * m2v) - 3.0;
+  for (int i = CI90; i <= CI99; i++)
+    summary.ci[i] = z_values[i] * summary.stddev / sn;
+  return summary;
+}
+
 RunningStats operator+( RunningStats const &a,  RunningStats const &b) {
   RunningStats combined;
 
+  if (a.n == 0)
+    return b;
+  if (b.n == 0)
+    return a;
+
   combined.n = a.n + b.n;
+  // counts as _float_t: n^3 and a.n - b.n must not wrap in _counter_t
+  _float_t na = a.n, nb = b.n, nc = combined.n;
+
+  // b's mean relative to a's shift; M2..M4 are central, so shift-free
+  _float_t a_M1 = a.m1();
+  _float_t b_M1 = b.m1() + (b.shift() - a.shift());
+  _float_t a_M2 = a.m2();
+  _float_t b_M2 = b.m2();
 
-  _float_t delta = b.M1 - a.M1;
+  _float_t delta = b_M1 - a_M1;
   _float_t delta2 = delta * delta;
   _float_t delta3 = delta * delta2;
   _float_t delta4 = delta2 * delta2;
 
-  combined.M1 = (a.n * a.M1 + b.n * b.M1) / combined.n;
+#if RS_ACCUMULATE & RS_SHIFTED
+  combined.K = a.K;
+#endif
+  combined.M1 = (na * a_M1 + nb * b_M1) / nc;
 
-  combined.M2 = a.M2 + b.M2 + delta2 * a.n * b.n / combined.n;
+  combined.M2 = a_M2 + b_M2 + delta2 * na * nb / nc;
 
   combined.M3 = a.M3 + b.M3 +
-                delta3 * a.n * b.n * (a.n - b.n) / (combined.n * combined.n);
-  combined.M3 += 3.0 * delta * (a.n * b.M2 - b.n * a.M2) / combined.n;
+                delta3 * na * nb * (na - nb) / (nc * nc);
+  combined.M3 += 3.0 * delta * (na * b_M2 - nb * a_M2) / nc;
 
   combined.M4 = a.M4 + b.M4 +
-                delta4 * a.n * b.n * (a.n * a.n - a.n * b.n + b.n * b.n) /
-                    (combined.n * combined.n * combined.n);
-  combined.M4 += 6.0 * delta2 * (a.n * a.n * b.M2 + b.n * b.n * a.M2) /
-                     (combined.n * combined.n) +
-                 4.0 * delta * (a.n * b.M3 - b.n * a.M3) / combined.n;
+                delta4 * na * nb * (na * na - na * nb + nb * nb) /
+                    (nc * nc * nc);
+  combined.M4 += 6.0 * delta2 * (na * na * b_M2 + nb * nb * a_M2) /
+                     (nc * nc) +
+                 4.0 * delta * (na * b.M3 - nb * a.M3) / nc;
 
   return combined;
 }
@@ -10,6 +10,13 @@ typedef enum {
   CI99,
 } ci_t;
 
+// all derived statistics of a RunningStats, see Summary()
+struct RunningStatsSummary {
+  _counter_t n;
+  _float_t mean, variance, stddev, skewness, kurtosis;
+  _float_t ci[3]; // ConfidenceInterval() half-widths, indexed by ci_t
+};
+
 class RunningStats {
 public:
   RunningStats();
@@ -22,14 +29,28 @@ public:
   _float_t StandardDeviation() const;
   _float_t Skewness() const;
   _float_t Kurtosis() const;
-  _float_t ConfidenceInterval(ci_t ci);
+  _float_t ConfidenceInterval(ci_t ci) const;
+  // as if dx had been added to every value pushed so far
+  void Shift(_float_t dx);
+  // all of the above computed together, see CachedStats to keep it
+  RunningStatsSummary Summary() const;
 
   friend RunningStats operator+( RunningStats const &a,  RunningStats const &b);
   RunningStats &operator+=(const RunningStats &rhs);
 
 private:
+  _float_t m1() const;
+  _float_t m2() const;
+  _float_t shift() const;
+
   _counter_t n;
   _float_t M1, M2, M3, M4;
+#if RS_ACCUMULATE & RS_SHIFTED
+  _float_t K; // moments are of x - K
+#endif
+#if RS_ACCUMULATE & RS_COMPENSATED
+  _float_t cM1, cM2; // Kahan compensation of M1, M2
+#endif
 };
 
 #endif
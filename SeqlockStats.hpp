@@ -0,0 +1,130 @@
+#pragma once
+
+// publish an accumulator from one writer thread to any number of readers
+// without locks: readers get a consistent copy (never a new n with an old M2)
+// and retry if the writer was active while copying.
+//
+// SeqlockStats<RunningStats> latency;
+// latency.Push(x);                          // hot thread
+// RunningStats s = latency.Snapshot();      // monitoring thread
+// float m = s.Mean(), v = s.Variance();
+//
+// the writer pays two stores of the sequence counter per Push and never waits.
+// only one thread may call Push()/Modify(); readers only use Snapshot()/TryRead().
+
+#include <atomic>
+#include <string.h>
+#include <type_traits>
+
+#include "RollingVariance.hpp"
+
+/**
+ * @brief What a reader copies out of an accumulator: by default the whole
+ *        (trivially copyable) object
+ */
+template <typename Accumulator>
+struct SeqlockSnapshot {
+    static_assert(std::is_trivially_copyable<Accumulator>::value,
+                  "specialize SeqlockSnapshot for accumulators owning memory");
+    typedef Accumulator type;
+
+    static void Capture(const Accumulator &acc, type &out) {
+        memcpy(static_cast<void *>(&out), &acc, sizeof(acc));
+    }
+};
+
+/**
+ * @brief RollingVariance owns its window, readers only copy mean and variance
+ */
+template <typename T, int Mode>
+struct SeqlockSnapshot<RollingVariance<T, Mode>> {
+    struct type {
+        T mean, variance;
+        T Mean() const { return mean; }
+        T Variance() const { return variance; }
+    };
+
+    static void Capture(const RollingVariance<T, Mode> &acc, type &out) {
+        out.mean = acc.Mean();
+        out.variance = acc.Variance();
+    }
+};
+
+template <typename Accumulator>
+class SeqlockStats {
+  public:
+    typedef typename SeqlockSnapshot<Accumulator>::type snapshot_t;
+
+    /**
+     * @brief Constructor, arguments are passed on to the accumulator
+     */
+    template <typename... Args>
+    explicit SeqlockStats(Args... args) : _seq(0), _acc(args...) {}
+
+    /**
+     * @brief Push a sample into the accumulator (writer thread only)
+     */
+    template <typename... Args>
+    void Push(Args... x) {
+        uint32_t s = _seq.load(std::memory_order_relaxed);
+        _seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _acc.Push(x...);
+        _seq.store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Apply any other change, e.g. Clear() or +=, as one published update
+     * @param fn Called with a reference to the accumulator (writer thread only)
+     */
+    template <typename Fn>
+    void Modify(Fn fn) {
+        uint32_t s = _seq.load(std::memory_order_relaxed);
+        _seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        fn(_acc);
+        _seq.store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Try to copy out a consistent snapshot once
+     * @return false if the writer was active, out is then unusable
+     */
+    bool TryRead(snapshot_t &out) const {
+        uint32_t s = _seq.load(std::memory_order_acquire);
+        if (s & 1) {
+            return false;
+        }
+        SeqlockSnapshot<Accumulator>::Capture(_acc, out);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return _seq.load(std::memory_order_relaxed) == s;
+    }
+
+    /**
+     * @brief Copy out a consistent snapshot, retrying while the writer is active
+     */
+    snapshot_t Snapshot() const {
+        snapshot_t out;
+        while (!TryRead(out)) {
+        }
+        return out;
+    }
+
+    /**
+     * @brief Number of published updates so far
+     */
+    uint32_t Generation() const {
+        return _seq.load(std::memory_order_acquire) >> 1;
+    }
+
+    /**
+     * @brief Direct access to the live accumulator (writer thread only)
+     */
+    const Accumulator &Writer() const {
+        return _acc;
+    }
+
+  private:
+    std::atomic<uint32_t> _seq;
+    Accumulator _acc;
+};
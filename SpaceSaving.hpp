@@ -0,0 +1,317 @@
+#pragma once
+
+// heavy hitters: the k most frequent keys of a stream in k counters
+// (Metwally et al., Space-Saving)
+//
+// SpaceSaving<std::string> top(100);
+// top.Push("GET /api|tenant42");
+// top.ForEachTop([](const std::string &key, uint64_t count, uint64_t error) { ... });
+//
+// a key not monitored replaces the one with the smallest count c and starts
+// at c + weight with error c, so counts never underestimate, overestimate by
+// at most error, and any key with more than N / k occurrences is monitored.
+//
+// the counters sit in a min-heap on count (a hit is an increment and a short
+// sift-down), keys are found through an open-addressing index over their
+// hashes. Both are sized in the constructor; Push never allocates (beyond what
+// assigning a Key may need, e.g. a long std::string).
+//
+// operator+ merges two summaries (Cafaro et al.): a key missing from a full
+// summary is charged that summary's minimum count, then the k largest counts
+// are kept, which preserves the bounds above for the combined stream.
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+#include "KeyedStats.hpp"
+
+template <typename Key, typename Traits = KeyedStatsKey<Key>>
+class SpaceSaving {
+  public:
+    typedef typename Traits::lookup_t lookup_t;
+
+    struct Entry {
+        Key key;
+        uint64_t count, error;
+    };
+
+  private:
+    struct Counter {
+        Key key;
+        uint64_t error, hash;
+    };
+
+  public:
+
+    /**
+     * @brief Constructor for SpaceSaving
+     * @param k Number of counters, i.e. keys monitored at once
+     */
+    SpaceSaving(size_t k) : _k(k ? k : 1), _n(0), _total(0) {
+        size_t slots = 8;
+        while (slots < 2 * _k) {
+            slots <<= 1;
+        }
+        _mask = slots - 1;
+        _slots.assign(slots, npos);
+        _heap.resize(_k);
+        _counts.assign(_k + 1, ~uint64_t(0)); // one sentinel past the last node
+        _pos.resize(_k);
+        _entries.resize(_k);
+    }
+
+    void Clear() {
+        std::fill(_slots.begin(), _slots.end(), npos);
+        std::fill(_counts.begin(), _counts.end(), ~uint64_t(0));
+        _n = 0;
+        _total = 0;
+    }
+
+    static uint64_t Hash(lookup_t key) {
+        return Traits::Hash(key);
+    }
+
+    /**
+     * @brief Count weight occurrences of key
+     */
+    void Push(lookup_t key, uint64_t weight = 1) {
+        PushHashed(key, Hash(key), weight);
+    }
+
+    void PushHashed(lookup_t key, uint64_t hash, uint64_t weight = 1) {
+        _total += weight;
+        size_t s = Lookup(key, hash);
+        uint32_t e = _slots[s];
+        if (e != npos) {
+            size_t i = _pos[e];
+            _counts[i] += weight;
+            SiftDown(i);
+            return;
+        }
+        if (_n < _k) {
+            e = uint32_t(_n);
+            _entries[e].key = key;
+            _entries[e].error = 0;
+            _entries[e].hash = hash;
+            _slots[s] = e;
+            Append(e, weight);
+            return;
+        }
+        // replace the minimum: its counter stays at the heap root
+        e = _heap[0];
+        Counter &m = _entries[e];
+        Unlink(e);
+        m.error = _counts[0];
+        m.key = key;
+        m.hash = hash;
+        _slots[Lookup(key, hash)] = e;
+        _counts[0] += weight;
+        SiftDown(0);
+    }
+
+    /**
+     * @brief Upper bound of the count of key, 0 if it is not monitored
+     */
+    uint64_t Count(lookup_t key) const {
+        uint32_t e = _slots[Lookup(key, Hash(key))];
+        return e == npos ? 0 : _counts[_pos[e]];
+    }
+
+    /**
+     * @brief Maximum overestimate of Count(key)
+     */
+    uint64_t Error(lookup_t key) const {
+        uint32_t e = _slots[Lookup(key, Hash(key))];
+        return e == npos ? 0 : _entries[e].error;
+    }
+
+    /**
+     * @brief Smallest monitored count; any key not monitored occurred at most
+     *        this often
+     */
+    uint64_t MinCount() const {
+        return _n < _k ? 0 : _counts[0];
+    }
+
+    /**
+     * @brief The monitored keys, largest count first
+     */
+    std::vector<Entry> Top() const {
+        std::vector<Entry> out;
+        out.reserve(_n);
+        for (size_t i = 0; i < _n; i++) {
+            const Counter &c = _entries[_heap[i]];
+            out.push_back(Entry{c.key, _counts[i], c.error});
+        }
+        std::sort(out.begin(), out.end(), [](const Entry &a, const Entry &b) { return a.count > b.count; });
+        return out;
+    }
+
+    /**
+     * @brief Call fn(key, count, error) for the monitored keys, largest count first
+     */
+    template <typename Fn>
+    void ForEachTop(Fn fn) const {
+        for (const Entry &e : Top()) {
+            fn(e.key, e.count, e.error);
+        }
+    }
+
+    size_t Size() const {
+        return _n;
+    }
+
+    size_t Capacity() const {
+        return _k;
+    }
+
+    /**
+     * @brief Sum of all weights pushed
+     */
+    uint64_t Total() const {
+        return _total;
+    }
+
+    /**
+     * @brief Merge two summaries into one with the capacity of a
+     */
+    friend SpaceSaving operator+(const SpaceSaving &a, const SpaceSaving &b) {
+        uint64_t ma = a.MinCount(), mb = b.MinCount();
+        std::vector<Counter> all;
+        std::vector<uint64_t> counts;
+        all.reserve(a._n + b._n);
+        counts.reserve(a._n + b._n);
+        for (size_t i = 0; i < a._n; i++) {
+            Counter e = a._entries[a._heap[i]];
+            uint64_t count = a._counts[i];
+            uint32_t j = b._slots[b.Lookup(e.key, e.hash)];
+            if (j == npos) {
+                count += mb;
+                e.error += mb;
+            } else {
+                count += b._counts[b._pos[j]];
+                e.error += b._entries[j].error;
+            }
+            all.push_back(e);
+            counts.push_back(count);
+        }
+        for (size_t i = 0; i < b._n; i++) {
+            Counter e = b._entries[b._heap[i]];
+            if (a._slots[a.Lookup(e.key, e.hash)] == npos) {
+                e.error += ma;
+                all.push_back(e);
+                counts.push_back(b._counts[i] + ma);
+            }
+        }
+
+        std::vector<size_t> order(all.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        size_t keep = std::min(order.size(), a._k);
+        std::partial_sort(order.begin(), order.begin() + keep, order.end(),
+                          [&](size_t x, size_t y) { return counts[x] > counts[y]; });
+
+        SpaceSaving c(a._k);
+        c._total = a._total + b._total;
+        for (size_t i = 0; i < keep; i++) {
+            uint32_t e = uint32_t(c._n);
+            c._entries[e] = all[order[i]];
+            c._slots[c.Lookup(c._entries[e].key, c._entries[e].hash)] = e;
+            c.Append(e, counts[order[i]]);
+        }
+        return c;
+    }
+
+    SpaceSaving &operator+=(const SpaceSaving &rhs) {
+        *this = *this + rhs;
+        return *this;
+    }
+
+  private:
+    static constexpr uint32_t npos = ~uint32_t(0);
+
+    // index slot holding key, or the empty slot where it would go
+    size_t Lookup(lookup_t key, uint64_t hash) const {
+        size_t i = hash & _mask;
+        for (;;) {
+            uint32_t e = _slots[i];
+            if (e == npos || (_entries[e].hash == hash && _entries[e].key == key)) {
+                return i;
+            }
+            i = (i + 1) & _mask;
+        }
+    }
+
+    // drop entry e from the index, backward-shifting the probe chain
+    void Unlink(uint32_t e) {
+        size_t hole = Lookup(_entries[e].key, _entries[e].hash);
+        size_t j = hole;
+        for (;;) {
+            j = (j + 1) & _mask;
+            uint32_t f = _slots[j];
+            if (f == npos) {
+                break;
+            }
+            size_t home = _entries[f].hash & _mask;
+            if (((j - home) & _mask) >= ((j - hole) & _mask)) {
+                _slots[hole] = f;
+                hole = j;
+            }
+        }
+        _slots[hole] = npos;
+    }
+
+    // add entry e with count as the last heap node and restore heap order
+    void Append(uint32_t e, uint64_t count) {
+        size_t i = _n++;
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (_counts[parent] <= count) {
+                break;
+            }
+            Move(i, parent);
+            i = parent;
+        }
+        _heap[i] = e;
+        _counts[i] = count;
+        _pos[e] = uint32_t(i);
+    }
+
+    // counts only grow, so an update only ever moves a node down; the
+    // sentinel count past the last node keeps the child choice branch free
+    void SiftDown(size_t i) {
+        uint32_t e = _heap[i];
+        uint64_t c = _counts[i];
+        for (;;) {
+            size_t child = 2 * i + 1;
+            if (child >= _n) {
+                break;
+            }
+            child += _counts[child + 1] < _counts[child];
+            if (_counts[child] >= c) {
+                break;
+            }
+            Move(i, child);
+            i = child;
+        }
+        _heap[i] = e;
+        _counts[i] = c;
+        _pos[e] = uint32_t(i);
+    }
+
+    void Move(size_t to, size_t from) {
+        _heap[to] = _heap[from];
+        _counts[to] = _counts[from];
+        _pos[_heap[to]] = uint32_t(to);
+    }
+
+    size_t _k, _n, _mask;
+    uint64_t _total;
+    std::vector<uint32_t> _slots; // index: hash slot -> entry
+    std::vector<uint32_t> _heap;   // min-heap of counters on count
+    std::vector<uint64_t> _counts; // count of each heap node
+    std::vector<uint32_t> _pos;    // counter -> heap position
+    std::vector<Counter> _entries;
+};
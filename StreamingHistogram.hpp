@@ -0,0 +1,494 @@
+#pragma once
+
+// histogram of a stream with a fixed number of bins and no range given up
+// front (Ben-Haim & Tom-Tov): each bin is a centroid and a count, and when
+// there are too many the two closest centroids are merged
+//
+// StreamingHistogram<float> h(64);
+// h.Push(x);
+// h.Push(block, n);                 // sorted and merged a block at a time
+// float median = h.Quantile(0.5);
+// float below = h.CDF(threshold);
+// StreamingHistogram<float> all = h0 + h1;
+//
+// the bins are kept in flat sorted arrays: a Push is a binary search and a
+// short memmove, and once full the closest pair is read off the root of a
+// tournament tree of the gaps between neighbours, O(log bins). Each bin keeps
+// a slot in the tree while it moves in the arrays, so an insert or a merge
+// replays only the gaps it changed up the tree. Of equal gaps the tree picks
+// any one, not necessarily the leftmost pair.
+// A batch is cut into blocks of 16 * bins samples; a sorted block is
+// summarized by bins equal-count centroids, and those and the bins are
+// reduced back to bins at once, as are the bins of two merged histograms.
+// That saves the per-sample memmove and tree work, but the sort keeps a batch
+// well short of memory speed (see bench/bench_streaminghistogram.cpp).
+// Between centroids the density is taken to be linear, with
+// zero-count end points at the exact minimum and maximum.
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "CircularBuffer.hpp"
+#include "rstypes.h"
+
+template <typename T = _float_t>
+class StreamingHistogram {
+  public:
+    /**
+     * @brief Constructor for StreamingHistogram
+     * @param bins Maximum number of bins kept
+     */
+    StreamingHistogram(size_t bins) : _bins(bins > 1 ? bins : 2) {
+        _c.resize(_bins + 1);
+        _m.resize(_bins + 1);
+        _block.resize(16 * _bins);
+        _leaves = 1;
+        while (_leaves < _bins + 1) {
+            _leaves <<= 1;
+        }
+        _slot.resize(_bins + 1);
+        _sc.resize(_leaves);
+        _tree.resize(2 * _leaves);
+        _win.resize(2 * _leaves);
+        _free.reserve(_leaves);
+        Scratch(2 * _bins);
+        Clear();
+    }
+
+    void Clear() {
+        _k = 0;
+        _n = 0;
+        _treeValid = false;
+        _min = INFINITY;
+        _max = -INFINITY;
+    }
+
+    /**
+     * @brief Add a sample
+     */
+    void Push(T x) {
+        if (isnan(x)) {
+            return;
+        }
+        _n++;
+        _min = x < _min ? x : _min;
+        _max = x > _max ? x : _max;
+        size_t i = std::lower_bound(_c.begin(), _c.begin() + _k, x) - _c.begin();
+        if (i < _k && _c[i] == x) {
+            _m[i]++;
+            return;
+        }
+        if (!_treeValid) {
+            RebuildTree();
+        }
+        memmove(&_c[i + 1], &_c[i], (_k - i) * sizeof(T));
+        memmove(&_m[i + 1], &_m[i], (_k - i) * sizeof(_counter_t));
+        memmove(&_slot[i + 1], &_slot[i], (_k - i) * sizeof(uint32_t));
+        _c[i] = x;
+        _m[i] = 1;
+        _slot[i] = _free.back();
+        _free.pop_back();
+        _k++;
+        SetGap(i);
+        if (i > 0) {
+            SetGap(i - 1);
+        }
+        if (_k > _bins) {
+            MergeClosest();
+        }
+    }
+
+    /**
+     * @brief Add a batch of samples: each block is sorted, summarized by
+     *        bins equal-count centroids and merged with the bins in one pass
+     */
+    void Push(const T *x, size_t n) {
+        while (n) {
+            size_t b = 0;
+            for (; n && b < _block.size(); x++, n--) {
+                if (!isnan(*x)) {
+                    _block[b++] = *x;
+                }
+            }
+            if (b == 0) {
+                break;
+            }
+            std::sort(_block.begin(), _block.begin() + b);
+            _n += b;
+            _min = _block[0] < _min ? _block[0] : _min;
+            _max = _block[b - 1] > _max ? _block[b - 1] : _max;
+
+            // block centroids into _wc/_wm past the bins: one per distinct
+            // value if there are few enough, else equal-count chunks
+            size_t distinct = 1;
+            for (size_t i = 1; i < b; i++) {
+                distinct += _block[i] != _block[i - 1];
+            }
+            size_t s = _k;
+            size_t chunks = distinct <= _bins ? distinct : _bins;
+            for (size_t j = 0, lo = 0; j < chunks; j++) {
+                size_t hi = (j + 1) * b / chunks;
+                if (distinct <= _bins) {
+                    for (hi = lo + 1; hi < b && _block[hi] == _block[lo]; hi++) {
+                    }
+                }
+                double sum = 0;
+                for (size_t i = lo; i < hi; i++) {
+                    sum += _block[i];
+                }
+                T c = T(sum / double(hi - lo));
+                if (s > _k && _wc[s - 1] == c) {
+                    _wm[s - 1] += _counter_t(hi - lo);
+                } else {
+                    _wc[s] = c;
+                    _wm[s++] = _counter_t(hi - lo);
+                }
+                lo = hi;
+            }
+
+            // merge with the bins: both runs are sorted
+            size_t i = 0, j = _k, end = s;
+            s = 0;
+            while (i < _k || j < end) {
+                if (j == end || (i < _k && _c[i] <= _wc[j])) {
+                    Append(s, _c[i], _m[i]);
+                    i++;
+                } else {
+                    Append(s, _wc[j], _wm[j]);
+                    j++;
+                }
+            }
+            Reduce(s, _bins);
+        }
+    }
+
+    /**
+     * @brief Add the contents of a CircularBuffer
+     */
+    void Push(const CircularBuffer<T> &cb) {
+        for (T x : cb) {
+            Push(x);
+        }
+    }
+
+    /**
+     * @brief Estimated fraction of the samples <= x
+     */
+    T CDF(T x) const {
+        if (_n == 0) {
+            return NAN;
+        }
+        if (x < _min) {
+            return 0;
+        }
+        if (x >= _max) {
+            return 1;
+        }
+        double below = 0;
+        for (size_t i = 0; i + 1 < Points(); i++) {
+            T p0 = Point(i), p1 = Point(i + 1);
+            double m0 = Mass(i), m1 = Mass(i + 1);
+            if (x < p1) {
+                double u = p1 > p0 ? double(x - p0) / double(p1 - p0) : 1.0;
+                below += m0 * u + (m1 - m0) * u * u / 2;
+                break;
+            }
+            below += (m0 + m1) / 2;
+        }
+        return T(below / double(_n));
+    }
+
+    /**
+     * @brief Estimated value below which a fraction q of the samples lie
+     */
+    T Quantile(T q) const {
+        if (_n == 0) {
+            return NAN;
+        }
+        double target = double(q < 0 ? 0 : q > 1 ? 1 : q) * double(_n);
+        double below = 0;
+        for (size_t i = 0; i + 1 < Points(); i++) {
+            double m0 = Mass(i), m1 = Mass(i + 1);
+            double area = (m0 + m1) / 2;
+            if (below + area >= target && area > 0) {
+                // solve m0 u + (m1 - m0) u^2 / 2 = target - below for u
+                double r = target - below, d = m1 - m0, u;
+                if (fabs(d) < 1e-9 * area) {
+                    u = r / m0;
+                } else {
+                    u = (sqrt(m0 * m0 + 2 * d * r) - m0) / d;
+                }
+                u = u < 0 ? 0 : u > 1 ? 1 : u;
+                return Point(i) + T(u) * (Point(i + 1) - Point(i));
+            }
+            below += area;
+        }
+        return _max;
+    }
+
+    /**
+     * @brief Number of samples pushed
+     */
+    _counter_t Count() const {
+        return _n;
+    }
+
+    T Min() const {
+        return _min;
+    }
+
+    T Max() const {
+        return _max;
+    }
+
+    /**
+     * @brief Number of bins in use
+     */
+    size_t Bins() const {
+        return _k;
+    }
+
+    size_t Capacity() const {
+        return _bins;
+    }
+
+    T Centroid(size_t i) const {
+        return _c[i];
+    }
+
+    _counter_t BinCount(size_t i) const {
+        return _m[i];
+    }
+
+    /**
+     * @brief Histogram of both streams, with the capacity of a
+     */
+    friend StreamingHistogram operator+(const StreamingHistogram &a, const StreamingHistogram &b) {
+        StreamingHistogram c(a._bins);
+        c._n = a._n + b._n;
+        c._min = a._min < b._min ? a._min : b._min;
+        c._max = a._max > b._max ? a._max : b._max;
+        c.Scratch(a._k + b._k);
+        size_t i = 0, j = 0, s = 0;
+        while (i < a._k || j < b._k) {
+            if (j == b._k || (i < a._k && a._c[i] <= b._c[j])) {
+                c.Append(s, a._c[i], a._m[i]);
+                i++;
+            } else {
+                c.Append(s, b._c[j], b._m[j]);
+                j++;
+            }
+        }
+        c.Reduce(s, c._bins);
+        return c;
+    }
+
+    StreamingHistogram &operator+=(const StreamingHistogram &rhs) {
+        *this = *this + rhs;
+        return *this;
+    }
+
+  private:
+    // the bins plus zero-count end points at min and max
+    size_t Points() const {
+        return _k + 2;
+    }
+    T Point(size_t i) const {
+        return i == 0 ? _min : i == _k + 1 ? _max : _c[i - 1];
+    }
+    double Mass(size_t i) const {
+        return i == 0 || i == _k + 1 ? 0.0 : double(_m[i - 1]);
+    }
+
+    static T Merged(T c0, _counter_t m0, T c1, _counter_t m1) {
+        T c = c0 + (c1 - c0) * T(double(m1) / double(m0 + m1));
+        return c < c1 ? c : c1; // rounding must not reorder the bins
+    }
+
+    // the tree of single pushes: leaf s holds the gap from the bin in slot s
+    // to its right neighbour, each inner node the smaller gap of its children
+    // and, in _win, the slot it came from. A gap is kept as the bit pattern of
+    // the double, which orders like the gap as it is never negative and is
+    // exact for float and double; free slots and the last bin hold a key
+    // above every gap, infinite ones too.
+    static const uint64_t none = ~uint64_t(0);
+
+    static uint64_t Key(T gap) {
+        double g = double(gap);
+        uint64_t bits;
+        memcpy(&bits, &g, sizeof(bits));
+        return bits;
+    }
+
+    void SetLeaf(uint32_t s, uint64_t gap) {
+        size_t n = _leaves + s;
+        uint32_t w = s;
+        _tree[n] = gap;
+        _win[n] = s;
+        for (; n > 1; n >>= 1) {
+            uint64_t o = _tree[n ^ 1];
+            uint32_t ow = _win[n ^ 1];
+            uint64_t m = 0 - uint64_t(o < gap); // masks, the winner is random
+            gap ^= (gap ^ o) & m;
+            w ^= (w ^ ow) & uint32_t(m);
+            _tree[n >> 1] = gap;
+            _win[n >> 1] = w;
+        }
+    }
+
+    // the gap from the bin at i to the next one changed
+    void SetGap(size_t i) {
+        uint32_t s = _slot[i];
+        _sc[s] = _c[i];
+        SetLeaf(s, i + 1 < _k ? Key(_c[i + 1] - _c[i]) : none);
+    }
+
+    void RebuildTree() {
+        _free.clear();
+        for (size_t s = _leaves; s-- > _k;) {
+            _free.push_back(uint32_t(s));
+            _tree[_leaves + s] = none;
+        }
+        for (size_t i = 0; i < _k; i++) {
+            _slot[i] = uint32_t(i);
+            _sc[i] = _c[i];
+            _tree[_leaves + i] = i + 1 < _k ? Key(_c[i + 1] - _c[i]) : none;
+        }
+        for (size_t s = 0; s < _leaves; s++) {
+            _win[_leaves + s] = uint32_t(s);
+        }
+        for (size_t n = _leaves - 1; n; n--) {
+            bool r = _tree[2 * n + 1] < _tree[2 * n];
+            _tree[n] = _tree[2 * n + r];
+            _win[n] = _win[2 * n + r];
+        }
+        _treeValid = true;
+    }
+
+    // merge the closest pair of the bins, found at the root of the tree; with
+    // more than one bin that is always a bin and not the last one
+    void MergeClosest() {
+        uint32_t s = _win[1];
+        size_t best = std::lower_bound(_c.begin(), _c.begin() + _k, _sc[s]) - _c.begin();
+        while (_slot[best] != s) {
+            best++; // equal centroids after a merge
+        }
+        uint32_t gone = _slot[best + 1];
+        SetLeaf(gone, none);
+        _free.push_back(gone);
+        _c[best] = Merged(_c[best], _m[best], _c[best + 1], _m[best + 1]);
+        _m[best] += _m[best + 1];
+        _k--;
+        memmove(&_c[best + 1], &_c[best + 2], (_k - best - 1) * sizeof(T));
+        memmove(&_m[best + 1], &_m[best + 2], (_k - best - 1) * sizeof(_counter_t));
+        memmove(&_slot[best + 1], &_slot[best + 2], (_k - best - 1) * sizeof(uint32_t));
+        SetGap(best);
+        if (best > 0) {
+            SetGap(best - 1);
+        }
+    }
+
+    void Scratch(size_t s) {
+        if (_wc.size() < s) {
+            _wc.resize(s);
+            _wm.resize(s);
+            _prev.resize(s);
+            _next.resize(s);
+            _heap.reserve(3 * s);
+        }
+    }
+
+    // add a point to the sorted work arrays, folding equal centroids
+    void Append(size_t &s, T c, _counter_t m) {
+        if (s && _wc[s - 1] == c) {
+            _wm[s - 1] += m;
+        } else {
+            _wc[s] = c;
+            _wm[s] = m;
+            s++;
+        }
+    }
+
+    struct Gap {
+        T gap;
+        uint32_t i, j;
+        // heap order: smallest gap first, leftmost on ties
+        bool operator<(const Gap &o) const {
+            return gap > o.gap || (gap == o.gap && i > o.i);
+        }
+    };
+
+    // merge closest pairs of the s work points until target remain, then
+    // copy them to the bins; a popped gap is stale unless i and j are still
+    // neighbours at that distance
+    void Reduce(size_t s, size_t target) {
+        const uint32_t none = ~uint32_t(0);
+        _treeValid = false;
+        size_t alive = s;
+        if (s > target) {
+            _heap.clear();
+            for (size_t i = 0; i < s; i++) {
+                _prev[i] = i ? uint32_t(i - 1) : none;
+                _next[i] = i + 1 < s ? uint32_t(i + 1) : none;
+                if (i + 1 < s) {
+                    _heap.push_back(Gap{_wc[i + 1] - _wc[i], uint32_t(i), uint32_t(i + 1)});
+                }
+            }
+            std::make_heap(_heap.begin(), _heap.end());
+            while (alive > target) {
+                std::pop_heap(_heap.begin(), _heap.end());
+                Gap g = _heap.back();
+                _heap.pop_back();
+                uint32_t i = g.i, j = g.j;
+                if (_next[i] != j || _wm[i] == 0 || _wc[j] - _wc[i] != g.gap) {
+                    continue;
+                }
+                _wc[i] = Merged(_wc[i], _wm[i], _wc[j], _wm[j]);
+                _wm[i] += _wm[j];
+                _wm[j] = 0; // marks j merged
+                _next[i] = _next[j];
+                if (_next[j] != none) {
+                    _prev[_next[j]] = i;
+                    PushGap(i, _next[i]);
+                }
+                if (_prev[i] != none) {
+                    PushGap(_prev[i], i);
+                }
+                alive--;
+            }
+        }
+        _k = 0;
+        for (size_t i = 0; i < s; i++) {
+            if (_wm[i]) {
+                _c[_k] = _wc[i];
+                _m[_k] = _wm[i];
+                _k++;
+            }
+        }
+    }
+
+    void PushGap(uint32_t i, uint32_t j) {
+        _heap.push_back(Gap{_wc[j] - _wc[i], i, j});
+        std::push_heap(_heap.begin(), _heap.end());
+    }
+
+    size_t _bins, _k;
+    _counter_t _n;
+    T _min, _max;
+    std::vector<T> _c;           // centroids, sorted
+    std::vector<_counter_t> _m;  // counts
+    std::vector<T> _block;       // batch input, sorted
+    std::vector<T> _wc;          // work points of Reduce()
+    std::vector<_counter_t> _wm;
+    std::vector<uint32_t> _prev, _next;
+    std::vector<Gap> _heap;
+    size_t _leaves;              // tree of single pushes, see Key()
+    std::vector<uint32_t> _slot; // slot of each bin
+    std::vector<T> _sc;          // centroid of each slot
+    std::vector<uint64_t> _tree;
+    std::vector<uint32_t> _win;
+    std::vector<uint32_t> _free;
+    bool _treeValid;
+};
@@ -0,0 +1,408 @@
+// accuracy vs. throughput of the accumulators against exact references
+//
+// every accumulator is fed the same generated stream; the reference is a
+// two-pass long double computation with Kahan summation over the same
+// (double) samples, regenerated from the seed for the second pass, so
+// 10^8 samples need no storage. float configurations see the samples
+// rounded to float, which is part of the error they are charged with.
+//
+// built once per precision (accuracy_float, accuracy_double) and, for float,
+// per RS_ACCUMULATE mode (accuracy_float_shifted, ...): RunningStats and
+// RunningRegression use that binary's _float_t and mode, the templates are
+// run in both float and double and RollingVariance in every mode:
+//   accuracy_float [-n samples] [-b budget] [-o results.json]
+//
+// errors are relative: mean and intercept are scaled by max(|mean|, sd),
+// variance and slope by their reference value. with -b the fastest
+// configuration of each accumulator whose errors all stay within the budget
+// is listed per distribution.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RollingVariance.hpp"
+#include "RunningRegression.hpp"
+#include "RunningStats.hpp"
+#include "RunningVariance.hpp"
+#include "WindowVariance.hpp"
+#include "benchutil.h"
+
+#define CHUNK 4096
+#define SLOPE 2.0
+
+static const size_t windows[] = {64, 4096};
+
+// sample streams
+enum { DIST_NORMAL, DIST_OFFSET, DIST_HEAVY, DIST_CONSTANT, DIST_COUNT };
+static const char *dist_names[] = {"normal", "large_offset", "heavy_tail", "near_constant"};
+
+struct Generator {
+    BenchRng rng;
+    int dist;
+    bool have_spare;
+    double spare;
+
+    Generator(int dist, uint64_t seed) : rng(seed), dist(dist), have_spare(false), spare(0) {}
+
+    double normal() {
+        if (have_spare) {
+            have_spare = false;
+            return spare;
+        }
+        double u = 1.0 - rng.uniform(), v = rng.uniform();
+        double r = sqrt(-2.0 * log(u));
+        spare = r * sin(2 * M_PI * v);
+        have_spare = true;
+        return r * cos(2 * M_PI * v);
+    }
+
+    double next() {
+        switch (dist) {
+        case DIST_OFFSET:
+            return 1.0e6 + normal();
+        case DIST_HEAVY: // Pareto, alpha 2.5: finite variance, heavy tail
+            return pow(1.0 - rng.uniform(), -1.0 / 2.5);
+        case DIST_CONSTANT:
+            return 1000.0 + 1.0e-4 * normal();
+        default:
+            return normal();
+        }
+    }
+};
+
+struct KahanSum {
+    long double sum = 0, c = 0;
+    void add(long double x) {
+        long double y = x - c;
+        long double t = sum + y;
+        c = (t - sum) - y;
+        sum = t;
+    }
+};
+
+struct stat_t {
+    const char *name;
+    double value, reference;
+};
+
+// one accumulator configuration under test
+struct Probe {
+    std::string name;
+    const char *type;
+    const char *mode;
+    size_t window;
+    std::function<void(const double *x, const float *xf, const double *t, const float *tf, size_t n)> push;
+    std::function<void(std::vector<stat_t> &)> results;
+    double ns;
+};
+
+struct Reference {
+    double mean, sd, var_sample, var_pop;
+    double slope, intercept;
+    std::vector<double> win_mean, win_var_pop, win_var_sample;
+};
+
+template <typename T>
+static const char *type_name() {
+    return sizeof(T) == sizeof(float) ? "float" : "double";
+}
+
+template <typename T>
+static const T *pick(const double *x, const float *xf) {
+    if (sizeof(T) == sizeof(float)) {
+        return reinterpret_cast<const T *>(xf);
+    }
+    return reinterpret_cast<const T *>(x);
+}
+
+static const char *mode_name(int mode) {
+    static const char *names[] = {"plain", "shifted", "compensated", "shifted+compensated"};
+    return names[mode & (RS_SHIFTED | RS_COMPENSATED)];
+}
+
+template <typename T, int Mode>
+static void add_rolling(std::vector<Probe> &probes, size_t w) {
+    auto roll = std::make_shared<RollingVariance<T, Mode>>(w);
+    probes.push_back({"RollingVariance", type_name<T>(), mode_name(Mode), w,
+                      [roll](const double *x, const float *xf, const double *, const float *, size_t n) {
+                          const T *v = pick<T>(x, xf);
+                          for (size_t i = 0; i < n; i++) roll->Push(v[i]);
+                      },
+                      [roll](std::vector<stat_t> &s) {
+                          s.push_back({"mean", double(roll->Mean()), 0});
+                          s.push_back({"variance", double(roll->Variance()), 0});
+                      },
+                      0});
+}
+
+template <typename T>
+static void add_templates(std::vector<Probe> &probes) {
+    auto rv = std::make_shared<RunningVariance<T>>();
+    probes.push_back({"RunningVariance", type_name<T>(), mode_name(RS_PLAIN), 0,
+                      [rv](const double *x, const float *xf, const double *, const float *, size_t n) {
+                          const T *v = pick<T>(x, xf);
+                          for (size_t i = 0; i < n; i++) rv->Push(v[i]);
+                      },
+                      [rv](std::vector<stat_t> &s) {
+                          s.push_back({"mean", double(rv->Mean()), 0});
+                          s.push_back({"variance", double(rv->Variance()), 0});
+                      },
+                      0});
+    for (size_t k = 0; k < sizeof(windows) / sizeof(windows[0]); k++) {
+        size_t w = windows[k];
+        add_rolling<T, RS_PLAIN>(probes, w);
+        add_rolling<T, RS_SHIFTED>(probes, w);
+        add_rolling<T, RS_COMPENSATED>(probes, w);
+        add_rolling<T, RS_SHIFTED | RS_COMPENSATED>(probes, w);
+        auto wv = std::make_shared<WindowVariance<T>>(w);
+        probes.push_back({"WindowVariance", type_name<T>(), mode_name(RS_PLAIN), w,
+                          [wv](const double *x, const float *xf, const double *, const float *, size_t n) {
+                              const T *v = pick<T>(x, xf);
+                              for (size_t i = 0; i < n; i++) wv->Add(v[i]);
+                          },
+                          [wv](std::vector<stat_t> &s) {
+                              s.push_back({"mean", double(wv->Mean()), 0});
+                              s.push_back({"variance", double(wv->Variance()), 0});
+                          },
+                          0});
+    }
+}
+
+static std::vector<Probe> make_probes() {
+    std::vector<Probe> probes;
+    auto rs = std::make_shared<RunningStats>();
+    probes.push_back({"RunningStats", type_name<_float_t>(), mode_name(RS_ACCUMULATE), 0,
+                      [rs](const double *x, const float *xf, const double *, const float *, size_t n) {
+                          const _float_t *v = pick<_float_t>(x, xf);
+                          for (size_t i = 0; i < n; i++) rs->Push(v[i]);
+                      },
+                      [rs](std::vector<stat_t> &s) {
+                          s.push_back({"mean", double(rs->Mean()), 0});
+                          s.push_back({"variance", double(rs->Variance()), 0});
+                      },
+                      0});
+    auto rr = std::make_shared<RunningRegression>();
+    probes.push_back({"RunningRegression", type_name<_float_t>(), mode_name(RS_ACCUMULATE), 0,
+                      [rr](const double *x, const float *xf, const double *t, const float *tf, size_t n) {
+                          const _float_t *v = pick<_float_t>(x, xf);
+                          const _float_t *u = pick<_float_t>(t, tf);
+                          for (size_t i = 0; i < n; i++) rr->Push(u[i], v[i] + _float_t(SLOPE) * u[i]);
+                      },
+                      [rr](std::vector<stat_t> &s) {
+                          s.push_back({"slope", double(rr->Slope()), 0});
+                          s.push_back({"intercept", double(rr->Intercept()), 0});
+                      },
+                      0});
+    add_templates<float>(probes);
+    add_templates<double>(probes);
+    return probes;
+}
+
+// two passes over the regenerated stream
+static Reference reference(int dist, uint64_t seed, size_t n) {
+    Reference r;
+    Generator g1(dist, seed);
+    KahanSum sx, st, sy;
+    for (size_t i = 0; i < n; i++) {
+        double t = double(i) / n;
+        double x = g1.next();
+        sx.add(x);
+        st.add(t);
+        sy.add(x + SLOPE * t);
+    }
+    long double mx = sx.sum / n, mt = st.sum / n, my = sy.sum / n;
+
+    Generator g2(dist, seed);
+    KahanSum m2, stt, sty;
+    size_t wmax = windows[sizeof(windows) / sizeof(windows[0]) - 1];
+    std::vector<double> tail(wmax);
+    for (size_t i = 0; i < n; i++) {
+        double t = double(i) / n;
+        double x = g2.next();
+        m2.add((x - mx) * (x - mx));
+        stt.add((t - mt) * (t - mt));
+        sty.add((t - mt) * (x + SLOPE * t - my));
+        tail[i % wmax] = x;
+    }
+    r.mean = mx;
+    r.var_sample = m2.sum / (n - 1);
+    r.var_pop = m2.sum / n;
+    r.sd = sqrt(r.var_sample);
+    r.slope = sty.sum / stt.sum;
+    r.intercept = my - r.slope * mt;
+
+    for (size_t w : windows) {
+        KahanSum s, q;
+        for (size_t i = n - w; i < n; i++) s.add(tail[i % wmax]);
+        long double m = s.sum / w;
+        for (size_t i = n - w; i < n; i++) q.add((tail[i % wmax] - m) * (tail[i % wmax] - m));
+        r.win_mean.push_back(m);
+        r.win_var_pop.push_back(q.sum / w);
+        r.win_var_sample.push_back(q.sum / (w - 1));
+    }
+    return r;
+}
+
+static double rel_error(const stat_t &s, double scale) {
+    double d = fabs(s.value - s.reference);
+    if (scale == 0) {
+        return d;
+    }
+    return std::isfinite(d) ? d / scale : INFINITY;
+}
+
+struct row_t {
+    int dist;
+    std::string name;
+    const char *type;
+    const char *mode;
+    size_t window;
+    double ns;
+    std::vector<stat_t> stats;
+    std::vector<double> errors;
+    double worst;
+};
+
+int main(int argc, char **argv) {
+    size_t n = 1000000;
+    double budget = -1;
+    const char *out = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            n = size_t(strtod(argv[++i], NULL));
+        } else if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+            budget = strtod(argv[++i], NULL);
+        } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            out = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [-n samples] [-b budget] [-o results.json]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (n < windows[sizeof(windows) / sizeof(windows[0]) - 1]) {
+        fprintf(stderr, "need at least %zu samples\n", windows[sizeof(windows) / sizeof(windows[0]) - 1]);
+        return 1;
+    }
+
+    std::vector<row_t> rows;
+    std::vector<double> x(CHUNK), t(CHUNK);
+    std::vector<float> xf(CHUNK), tf(CHUNK);
+
+    for (int dist = 0; dist < DIST_COUNT; dist++) {
+        uint64_t seed = 0x9E3779B97F4A7C15ULL + dist;
+        std::vector<Probe> probes = make_probes();
+        Generator g(dist, seed);
+
+        for (size_t done = 0; done < n;) {
+            size_t m = n - done < CHUNK ? n - done : CHUNK;
+            for (size_t i = 0; i < m; i++) {
+                x[i] = g.next();
+                t[i] = double(done + i) / n;
+                xf[i] = float(x[i]);
+                tf[i] = float(t[i]);
+            }
+            for (Probe &p : probes) {
+                double t0 = now_ns();
+                p.push(x.data(), xf.data(), t.data(), tf.data(), m);
+                p.ns += now_ns() - t0;
+            }
+            done += m;
+        }
+
+        Reference ref = reference(dist, seed, n);
+        for (Probe &p : probes) {
+            row_t row = {dist, p.name, p.type, p.mode, p.window, p.ns / n, {}, {}, 0};
+            p.results(row.stats);
+            size_t k = 0;
+            while (p.window && windows[k] != p.window) k++;
+            for (stat_t &s : row.stats) {
+                double scale;
+                if (!strcmp(s.name, "slope")) {
+                    s.reference = ref.slope;
+                    scale = fabs(ref.slope);
+                } else if (!strcmp(s.name, "intercept")) {
+                    s.reference = ref.intercept;
+                    scale = fmax(fabs(ref.intercept), ref.sd);
+                } else if (!strcmp(s.name, "mean")) {
+                    s.reference = p.window ? ref.win_mean[k] : ref.mean;
+                    scale = p.window ? fmax(fabs(s.reference), sqrt(ref.win_var_sample[k])) : fmax(fabs(ref.mean), ref.sd);
+                } else {
+                    // RollingVariance divides by the window, the others by n - 1
+                    if (p.window) {
+                        s.reference = p.name == "RollingVariance" ? ref.win_var_pop[k] : ref.win_var_sample[k];
+                    } else {
+                        s.reference = ref.var_sample;
+                    }
+                    scale = s.reference;
+                }
+                double e = rel_error(s, scale);
+                row.errors.push_back(e);
+                row.worst = fmax(row.worst, e);
+            }
+            rows.push_back(row);
+            fprintf(stderr, "%-14s %-18s %-6s %-19s %5zu %8.2f ns/sample", dist_names[dist], p.name.c_str(), p.type,
+                    p.mode, p.window, row.ns);
+            for (size_t i = 0; i < row.stats.size(); i++) {
+                fprintf(stderr, "  %s %.2e", row.stats[i].name, row.errors[i]);
+            }
+            fprintf(stderr, "\n");
+        }
+    }
+
+    if (budget >= 0) {
+        fprintf(stderr, "\nfastest configuration within relative error %g:\n", budget);
+        for (size_t i = 0; i < rows.size(); i++) {
+            const row_t &r = rows[i];
+            // one line per distribution, accumulator and window
+            bool first = true;
+            for (size_t j = 0; j < i; j++) {
+                first = first && !(rows[j].dist == r.dist && rows[j].name == r.name && rows[j].window == r.window);
+            }
+            if (!first) continue;
+            const row_t *best = NULL;
+            for (const row_t &c : rows) {
+                if (c.dist == r.dist && c.name == r.name && c.window == r.window && c.worst <= budget &&
+                    (best == NULL || c.ns < best->ns)) {
+                    best = &c;
+                }
+            }
+            fprintf(stderr, "%-14s %-18s %5zu -> ", dist_names[r.dist], r.name.c_str(), r.window);
+            if (best) {
+                fprintf(stderr, "%s %s (%.2f ns/sample)\n", best->type, best->mode, best->ns);
+            } else {
+                fprintf(stderr, "none\n");
+            }
+        }
+    }
+
+    FILE *f = out ? fopen(out, "w") : stdout;
+    if (f == NULL) {
+        perror(out);
+        return 1;
+    }
+    fprintf(f, "{\n  \"precision\": \"%s\",\n  \"samples\": %zu,\n  \"results\": [\n", type_name<_float_t>(), n);
+    for (size_t i = 0; i < rows.size(); i++) {
+        const row_t &r = rows[i];
+        fprintf(f, "    {\"distribution\": \"%s\", \"name\": \"%s\", \"type\": \"%s\", \"mode\": \"%s\", \"window\": %zu, \"ns_per_sample\": %.3f",
+                dist_names[r.dist], r.name.c_str(), r.type, r.mode, r.window, r.ns);
+        for (size_t k = 0; k < r.stats.size(); k++) {
+            if (std::isfinite(r.errors[k])) {
+                fprintf(f, ", \"%s_rel_error\": %.3e", r.stats[k].name, r.errors[k]);
+            } else {
+                fprintf(f, ", \"%s_rel_error\": null", r.stats[k].name);
+            }
+        }
+        fprintf(f, "}%s\n", i + 1 < rows.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    if (out) {
+        fclose(f);
+    }
+    return 0;
+}
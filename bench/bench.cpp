@@ -0,0 +1,168 @@
+// per-class throughput in ns/push and ns/query, written as JSON
+//
+// built once per precision (bench_float, bench_double), see CMakeLists.txt:
+//   bench_float [-o results.json] [-n pushes]
+//
+// a "query" is the class' main derived statistic, e.g. Variance(); for
+// WindowVariance and CircularBuffer it is a pass over the window.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "CircularBuffer.hpp"
+#include "ExponentialSmoothing.hpp"
+#include "RollingVariance.hpp"
+#include "RunningRegression.hpp"
+#include "RunningStats.hpp"
+#include "RunningVariance.hpp"
+#include "WindowVariance.hpp"
+#ifdef RUNNINGSTATS_HAVE_EIGEN
+#include "QuadraticFitOnline.hpp"
+#endif
+#include "benchutil.h"
+
+#ifndef RUNNINGSTATS_VERSION
+#define RUNNINGSTATS_VERSION "unknown"
+#endif
+
+#define INPUT_SIZE (1 << 16)
+#define INPUT_MASK (INPUT_SIZE - 1)
+
+static const size_t windows[] = {16, 256, 4096};
+
+struct result_t {
+    const char *name;
+    const char *type;
+    size_t window;
+    double push_ns, query_ns;
+};
+
+static std::vector<result_t> results;
+static std::vector<_float_t> input(INPUT_SIZE);
+static size_t pushes = 1 << 22;
+
+template <typename T>
+static const char *type_name() {
+    return sizeof(T) == sizeof(float) ? "float" : "double";
+}
+
+// average ns per call of fn(i) over n calls
+template <typename Fn>
+static double time_per(size_t n, Fn fn) {
+    double t0 = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        fn(i);
+    }
+    return (now_ns() - t0) / n;
+}
+
+// queries which walk the whole window get fewer iterations
+static size_t queries(size_t window) {
+    size_t n = pushes / (window > 16 ? window / 16 : 1);
+    return n ? n : 1;
+}
+
+static void record(const char *name, const char *type, size_t window, double push_ns, double query_ns) {
+    results.push_back({name, type, window, push_ns, query_ns});
+    fprintf(stderr, "%-22s %-6s %6zu %10.2f ns/push %10.2f ns/query\n", name, type, window, push_ns, query_ns);
+}
+
+static void bench_running() {
+    RunningStats rs;
+    double p = time_per(pushes, [&](size_t i) { rs.Push(input[i & INPUT_MASK]); });
+    double q = time_per(pushes, [&](size_t) { keep(rs.StandardDeviation()); });
+    record("RunningStats", type_name<_float_t>(), 0, p, q);
+
+    RunningVariance<_float_t> rv;
+    p = time_per(pushes, [&](size_t i) { rv.Push(input[i & INPUT_MASK]); });
+    q = time_per(pushes, [&](size_t) { keep(rv.Variance()); });
+    record("RunningVariance", type_name<_float_t>(), 0, p, q);
+
+    RunningRegression rr;
+    p = time_per(pushes, [&](size_t i) { rr.Push(_float_t(i & INPUT_MASK), input[i & INPUT_MASK]); });
+    q = time_per(pushes, [&](size_t) { keep(rr.Slope()); keep(rr.Intercept()); });
+    record("RunningRegression", type_name<_float_t>(), 0, p, q);
+
+    ExponentialSmoothing es(0.1);
+    p = time_per(pushes, [&](size_t i) { es.Push(input[i & INPUT_MASK]); });
+    q = time_per(pushes, [&](size_t) { keep(es.Value()); });
+    record("ExponentialSmoothing", type_name<_float_t>(), 0, p, q);
+
+#ifdef RUNNINGSTATS_HAVE_EIGEN
+    QuadraticFitOnline qf;
+    p = time_per(pushes, [&](size_t i) { qf.update(float(i & INPUT_MASK) * 1e-4f, float(input[i & INPUT_MASK])); });
+    q = time_per(pushes, [&](size_t i) { keep(qf.predict(float(i & INPUT_MASK) * 1e-4f)); });
+    record("QuadraticFitOnline", "float", 0, p, q);
+#endif
+}
+
+static void bench_windowed(size_t w) {
+    RollingVariance<_float_t> rv(w);
+    double p = time_per(pushes, [&](size_t i) { rv.Push(input[i & INPUT_MASK]); });
+    double q = time_per(pushes, [&](size_t) { keep(rv.Variance()); });
+    record("RollingVariance", type_name<_float_t>(), w, p, q);
+
+    WindowVariance<_float_t> wv(w);
+    p = time_per(pushes, [&](size_t i) { wv.Add(input[i & INPUT_MASK]); });
+    q = time_per(queries(w), [&](size_t) { keep(wv.Variance()); });
+    record("WindowVariance", type_name<_float_t>(), w, p, q);
+
+    CircularBuffer<_float_t> cb(w);
+    p = time_per(pushes, [&](size_t i) { cb.push(input[i & INPUT_MASK]); });
+    q = time_per(queries(w), [&](size_t) {
+        _float_t sum = 0;
+        for (_float_t x : cb) {
+            sum += x;
+        }
+        keep(sum);
+    });
+    record("CircularBuffer", type_name<_float_t>(), w, p, q);
+}
+
+static void write_json(FILE *f) {
+    fprintf(f, "{\n  \"library\": \"runningstats\",\n  \"version\": \"%s\",\n", RUNNINGSTATS_VERSION);
+    fprintf(f, "  \"precision\": \"%s\",\n  \"pushes\": %zu,\n  \"results\": [\n", type_name<_float_t>(), pushes);
+    for (size_t i = 0; i < results.size(); i++) {
+        const result_t &r = results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"type\": \"%s\", \"window\": %zu, \"push_ns\": %.3f, \"query_ns\": %.3f}%s\n",
+                r.name, r.type, r.window, r.push_ns, r.query_ns, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+    const char *out = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            out = argv[++i];
+        } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            pushes = strtoull(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "usage: %s [-o results.json] [-n pushes]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    BenchRng rng;
+    for (auto &x : input) {
+        x = rng.uniform() * 100.0;
+    }
+
+    bench_running();
+    for (size_t w : windows) {
+        bench_windowed(w);
+    }
+
+    FILE *f = out ? fopen(out, "w") : stdout;
+    if (f == NULL) {
+        perror(out);
+        return 1;
+    }
+    write_json(f);
+    if (out) {
+        fclose(f);
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+// RunningAutocorrelation per sample and per FFT block vs. an offline ACF per
+// frame, ns per sample, frames of 4096 samples, L = 16 .. 1024
+//
+// g++ -std=c++17 -O3 -I.. bench_autocorrelation.cpp   (the Push loop needs -O3 to vectorize)
+
+#include <iostream>
+#include <vector>
+
+#include "RunningAutocorrelation.hpp"
+#include "benchutil.h"
+
+#define FRAME 4096
+#define FRAMES 32
+
+int main() {
+    std::vector<float> input(FRAME * FRAMES);
+    BenchRng rng;
+    for (auto &x : input) x = rng.uniform();
+
+    std::cout << "lags\tPush ns/sample\tPushBlock ns/sample\toffline ns/sample\n";
+    for (size_t L = 16; L <= 1024; L *= 4) {
+        std::vector<float> out(L + 1);
+
+        RunningAutocorrelation<float> ac(L);
+        double t0 = now_ns();
+        for (float x : input) ac.Push(x);
+        ac.Autocovariances(out.data());
+        keep(out[L]);
+        double stream = (now_ns() - t0) / input.size();
+
+        RunningAutocorrelation<float> ab(L);
+        t0 = now_ns();
+        for (size_t f = 0; f < FRAMES; f++) ab.PushBlock(input.data() + f * FRAME, FRAME);
+        ab.Autocovariances(out.data());
+        keep(out[L]);
+        double block = (now_ns() - t0) / input.size();
+
+        // what the per-frame dump does: mean, then O(W L) products
+        t0 = now_ns();
+        for (size_t f = 0; f < FRAMES; f++) {
+            const float *x = input.data() + f * FRAME;
+            float m = 0;
+            for (size_t i = 0; i < FRAME; i++) m += x[i];
+            m /= FRAME;
+            for (size_t k = 0; k <= L; k++) {
+                float c = 0;
+                for (size_t i = k; i < FRAME; i++) c += (x[i] - m) * (x[i - k] - m);
+                out[k] = c / FRAME;
+            }
+            keep(out[L]);
+        }
+        double offline = (now_ns() - t0) / input.size();
+
+        std::cout << L << "\t" << stream << "\t" << block << "\t" << offline << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+// fixed-point classes of FixedPoint.hpp vs. their float counterparts, cycles/call
+//
+// g++ -std=c++17 -O2 -I.. bench_fixedpoint.cpp
+//
+// on a host with an FPU the float versions are not slower; the interesting
+// number is the fixed-point column, which is what an FPU-less core pays too
+// (modulo its multiplier), while float there costs soft-float calls.
+
+#include <iostream>
+#include <vector>
+
+#include "ExponentialSmoothing.hpp"
+#include "FixedPoint.hpp"
+#include "RollingVariance.hpp"
+#include "RunningVariance.hpp"
+#include "benchutil.h"
+
+#define SAMPLES (1 << 20)
+
+static std::vector<float> fin(SAMPLES);
+static std::vector<int32_t> qin(SAMPLES);
+
+// average cycles per call of fn(i)
+template <typename Fn>
+static double cycles_per(Fn fn) {
+    uint64_t c0 = cycles();
+    for (size_t i = 0; i < SAMPLES; i++) {
+        fn(i);
+    }
+    return double(cycles() - c0) / SAMPLES;
+}
+
+static void report(const char *name, double f, double q) {
+    std::cout << name << "\t" << f << "\t" << q << "\n";
+}
+
+int main() {
+    BenchRng rng;
+    for (size_t i = 0; i < SAMPLES; i++) {
+        fin[i] = 1000.0f + float(rng.uniform()) * 64.0f;
+        qin[i] = rs_to_fixed<8>(fin[i]);
+    }
+
+    std::cout << "class\tfloat cycles/call\tQ8 cycles/call\n";
+
+    RunningVariance<float> rv;
+    FixedRunningVariance<8> frv;
+    double f = cycles_per([&](size_t i) { rv.Push(fin[i]); });
+    double q = cycles_per([&](size_t i) { frv.Push(qin[i]); });
+    keep(rv.Variance());
+    keep(frv.Variance());
+    report("RunningVariance", f, q);
+
+    for (size_t w : {16, 256, 4096}) {
+        RollingVariance<float> rw(w);
+        FixedRollingVariance<8> frw(w);
+        f = cycles_per([&](size_t i) { rw.Push(fin[i]); });
+        q = cycles_per([&](size_t i) { frw.Push(qin[i]); });
+        std::cout << "W=" << w << " ";
+        report("RollingVariance", f, q);
+        f = cycles_per([&](size_t) { keep(rw.Variance()); });
+        q = cycles_per([&](size_t) { keep(frw.Variance()); });
+        std::cout << "W=" << w << " ";
+        report("RollingVariance::Variance()", f, q);
+    }
+
+    ExponentialSmoothing es(0.125);
+    FixedExponentialSmoothing<8> fes(3);
+    f = cycles_per([&](size_t i) { es.Push(fin[i]); });
+    q = cycles_per([&](size_t i) { fes.Push(qin[i]); });
+    keep(es.Value());
+    keep(fes.Value());
+    report("ExponentialSmoothing", f, q);
+    return 0;
+}
@@ -0,0 +1,48 @@
+// KalmanBank vs. one KalmanFilter per channel, ns per channel update,
+// 4096 channels, N = 1, 2, 4
+//
+// g++ -std=c++17 -O3 -I.. bench_kalman.cpp
+
+#include <iostream>
+#include <vector>
+
+#include "KalmanFilter.hpp"
+#include "benchutil.h"
+
+#define CHANNELS 4096
+#define FRAMES 500
+
+template <int N>
+static void run() {
+    std::vector<float> z(CHANNELS * FRAMES), out(CHANNELS);
+    BenchRng rng;
+    for (auto &v : z) v = float(rng.uniform());
+
+    KalmanFilter<N, float> proto(1e-4f, 0.1f);
+    std::vector<KalmanFilter<N, float>> single(CHANNELS, proto);
+    double t0 = now_ns();
+    for (int f = 0; f < FRAMES; f++) {
+        const float *frame = &z[f * CHANNELS];
+        for (size_t c = 0; c < CHANNELS; c++) out[c] = single[c].Push(frame[c]);
+        keep(out[f]);
+    }
+    double loop = (now_ns() - t0) / (FRAMES * CHANNELS);
+
+    KalmanBank<N, float> bank(CHANNELS, proto);
+    t0 = now_ns();
+    for (int f = 0; f < FRAMES; f++) {
+        bank.Push(&z[f * CHANNELS], out.data());
+        keep(out[f]);
+    }
+    double soa = (now_ns() - t0) / (FRAMES * CHANNELS);
+
+    std::cout << N << "\t" << loop << "\t" << soa << "\n";
+}
+
+int main() {
+    std::cout << "states\tKalmanFilter ns/channel\tKalmanBank ns/channel\n";
+    run<1>();
+    run<2>();
+    run<4>();
+    return 0;
+}
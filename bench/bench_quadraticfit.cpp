@@ -0,0 +1,60 @@
+// QuadraticFitOnline per frame of 1024 points: refit, evaluate, residual stats
+// with per-point update()/predict() vs. the batch calls
+//
+// g++ -std=c++17 -O3 -I.. -I/usr/include/eigen3 bench_quadraticfit.cpp ../RunningStats.cpp
+
+#include <iostream>
+#include <vector>
+
+#include "QuadraticFitOnline.hpp"
+#include "benchutil.h"
+
+#define POINTS 1024
+#define FRAMES 2000
+
+int main() {
+    std::vector<float> x(POINTS), y(POINTS), p(POINTS);
+    BenchRng rng;
+    for (size_t i = 0; i < POINTS; i++) {
+        x[i] = float(i) / POINTS;
+        y[i] = 1 + x[i] * (2 - x[i]) + 0.01f * float(rng.uniform());
+    }
+
+    QuadraticFitOnline single;
+    double t0 = now_ns();
+    for (int f = 0; f < FRAMES; f++) {
+        RunningStats res;
+        for (size_t i = 0; i < POINTS; i++) single.update(x[i], y[i]);
+        for (size_t i = 0; i < POINTS; i++) res.Push(y[i] - single.predict(x[i]));
+        keep(res.StandardDeviation());
+    }
+    double per_point = (now_ns() - t0) / FRAMES;
+
+    QuadraticFitOnline batch;
+    t0 = now_ns();
+    for (int f = 0; f < FRAMES; f++) {
+        RunningStats res;
+        batch.update(x.data(), y.data(), POINTS, &res);
+        keep(res.StandardDeviation());
+    }
+    double batched = (now_ns() - t0) / FRAMES;
+
+    // evaluation alone, 1024 points
+    t0 = now_ns();
+    for (int f = 0; f < FRAMES; f++) {
+        for (size_t i = 0; i < POINTS; i++) p[i] = single.predict(x[i]);
+        keep(p[f % POINTS]);
+    }
+    double predict_single = (now_ns() - t0) / FRAMES;
+    t0 = now_ns();
+    for (int f = 0; f < FRAMES; f++) {
+        batch.predict(x.data(), p.data(), POINTS);
+        keep(p[f % POINTS]);
+    }
+    double predict_batch = (now_ns() - t0) / FRAMES;
+
+    std::cout << "us/frame\tper point\tbatch\n";
+    std::cout << "fit+residuals\t" << per_point / 1e3 << "\t" << batched / 1e3 << "\n";
+    std::cout << "predict\t" << predict_single / 1e3 << "\t" << predict_batch / 1e3 << "\n";
+    return 0;
+}
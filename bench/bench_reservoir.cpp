@@ -0,0 +1,66 @@
+// Reservoir (Algorithm L) vs. Algorithm R (one random number per item), and
+// DecayingReservoir, ns per item, k = 1000
+//
+// g++ -std=c++17 -O3 -I.. bench_reservoir.cpp
+
+#include <iostream>
+#include <vector>
+
+#include "Reservoir.hpp"
+#include "benchutil.h"
+
+#define K 1000
+#define ITEMS 20000000
+
+int main() {
+    std::vector<float> x(ITEMS);
+    std::vector<uint64_t> t(ITEMS);
+    BenchRng rng;
+    for (size_t i = 0; i < ITEMS; i++) {
+        x[i] = float(rng.uniform());
+        t[i] = i;
+    }
+
+    // Algorithm R for reference
+    std::vector<float> r;
+    r.reserve(K);
+    ReservoirRng rr(1);
+    double t0 = now_ns();
+    for (size_t i = 0; i < ITEMS; i++) {
+        if (r.size() < K) {
+            r.push_back(x[i]);
+        } else {
+            size_t j = rr.Below(i + 1);
+            if (j < K) r[j] = x[i];
+        }
+    }
+    double algR = (now_ns() - t0) / ITEMS;
+    keep(r[0]);
+
+    Reservoir<float> single(K);
+    t0 = now_ns();
+    for (size_t i = 0; i < ITEMS; i++) single.Push(x[i]);
+    double algL = (now_ns() - t0) / ITEMS;
+    keep(single[0]);
+
+    Reservoir<float> batch(K);
+    t0 = now_ns();
+    for (size_t i = 0; i < ITEMS; i += 4096) {
+        batch.Push(&x[i], ITEMS - i < 4096 ? ITEMS - i : 4096);
+    }
+    double algLBatch = (now_ns() - t0) / ITEMS;
+    keep(batch[0]);
+
+    DecayingReservoir<float> decay(K, 1e-6);
+    t0 = now_ns();
+    decay.Push(t.data(), x.data(), ITEMS);
+    double dec = (now_ns() - t0) / ITEMS;
+    keep(decay[0]);
+
+    std::cout << "reservoir\tns/item\n"
+              << "Algorithm R\t" << algR << "\n"
+              << "Reservoir Push\t" << algL << "\n"
+              << "Reservoir batch Push\t" << algLBatch << "\n"
+              << "DecayingReservoir\t" << dec << "\n";
+    return 0;
+}
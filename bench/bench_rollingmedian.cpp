@@ -0,0 +1,50 @@
+// RollingMedian vs. copy + nth_element over a CircularBuffer, W = 16 .. 65536
+//
+// g++ -std=c++17 -O2 -I.. bench_rollingmedian.cpp
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "CircularBuffer.hpp"
+#include "RollingMedian.hpp"
+#include "benchutil.h"
+
+#define SAMPLES 200000
+
+int main() {
+    std::vector<float> input(SAMPLES);
+    BenchRng rng;
+    for (auto &x : input) x = rng.uniform();
+
+    std::cout << "window\tRollingMedian ns/push\tnth_element ns/push\n";
+    for (size_t w = 16; w <= 65536; w *= 4) {
+        // time the steady state, with a full window
+        RollingMedian<float> rm(w);
+        for (size_t i = 0; i < w; i++) rm.Push(input[i % SAMPLES]);
+        double t0 = now_ns();
+        for (float x : input) {
+            rm.Push(x);
+            keep(rm.Median());
+        }
+        double heap = (now_ns() - t0) / SAMPLES;
+
+        // baseline is O(W) per sample, keep its total work bounded
+        size_t n = std::min<size_t>(SAMPLES, 200000000 / w);
+        CircularBuffer<float> cb(w);
+        for (size_t i = 0; i < w; i++) cb.push(input[i % SAMPLES]);
+        std::vector<float> tmp;
+        tmp.reserve(w);
+        t0 = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            cb.push(input[i]);
+            tmp.assign(cb.begin(), cb.end());
+            std::nth_element(tmp.begin(), tmp.begin() + tmp.size() / 2, tmp.end());
+            keep(tmp[tmp.size() / 2]);
+        }
+        double copy = (now_ns() - t0) / n;
+
+        std::cout << w << "\t" << heap << "\t" << copy << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+// HyperLogLog and SpaceSaving update cost vs. exact counting with
+// std::unordered_set / std::unordered_map, ns per key, and memory
+//
+// g++ -std=c++17 -O3 -I.. bench_sketches.cpp
+
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "HyperLogLog.hpp"
+#include "SpaceSaving.hpp"
+#include "benchutil.h"
+
+#define KEYS 4000000
+#define DISTINCT 1000000
+
+int main() {
+    // skewed stream: half the traffic on 1% of the keys
+    std::vector<uint64_t> keys(KEYS), hashes(KEYS);
+    BenchRng rng;
+    for (size_t i = 0; i < KEYS; i++) {
+        uint64_t r = rng.next();
+        keys[i] = r & 1 ? (r >> 1) % (DISTINCT / 100) : (r >> 1) % DISTINCT;
+        hashes[i] = HashMix64(keys[i]);
+    }
+
+    HyperLogLog hll(14);
+    double t0 = now_ns();
+    for (size_t i = 0; i < KEYS; i++) hll.PushHashed(hashes[i]);
+    double single = (now_ns() - t0) / KEYS;
+    keep(hll);
+
+    hll.Clear();
+    t0 = now_ns();
+    hll.PushHashed(hashes.data(), KEYS);
+    double batch = (now_ns() - t0) / KEYS;
+
+    t0 = now_ns();
+    double estimate = hll.Estimate();
+    double est_us = (now_ns() - t0) * 1e-3;
+
+    std::unordered_set<uint64_t> set;
+    t0 = now_ns();
+    for (size_t i = 0; i < KEYS; i++) set.insert(keys[i]);
+    double exact_set = (now_ns() - t0) / KEYS;
+
+    std::cout << "distinct count\tns/key\n"
+              << "HyperLogLog(14) PushHashed\t" << single << "\n"
+              << "HyperLogLog(14) batch\t" << batch << "\n"
+              << "std::unordered_set\t" << exact_set << "\n"
+              << "estimate " << estimate << " of " << set.size() << " in " << est_us << " us, 16 KB\n\n";
+
+    SpaceSaving<uint64_t> top(1000);
+    t0 = now_ns();
+    for (size_t i = 0; i < KEYS; i++) top.PushHashed(keys[i], hashes[i]);
+    double ss = (now_ns() - t0) / KEYS;
+    keep(top);
+
+    std::unordered_map<uint64_t, uint64_t> counts;
+    t0 = now_ns();
+    for (size_t i = 0; i < KEYS; i++) counts[keys[i]]++;
+    double exact_map = (now_ns() - t0) / KEYS;
+
+    std::cout << "heavy hitters\tns/key\n"
+              << "SpaceSaving(1000)\t" << ss << "\n"
+              << "std::unordered_map\t" << exact_map << "\n"
+              << "min monitored count " << top.MinCount() << " of " << KEYS << " keys\n";
+    return 0;
+}
@@ -0,0 +1,41 @@
+// StreamingHistogram single Push vs. sorted batch Push, ns per sample
+//
+// g++ -std=c++17 -O3 -I.. bench_streaminghistogram.cpp
+
+#include <iostream>
+#include <vector>
+
+#include "StreamingHistogram.hpp"
+#include "benchutil.h"
+
+#define SAMPLES 4000000
+
+static void run(size_t bins, const std::vector<float> &x) {
+    StreamingHistogram<float> single(bins), batch(bins);
+    double t0 = now_ns();
+    for (float v : x) single.Push(v);
+    double ns1 = (now_ns() - t0) / x.size();
+    keep(single.Quantile(0.5f));
+
+    t0 = now_ns();
+    for (size_t i = 0; i < x.size(); i += 4096) {
+        batch.Push(&x[i], x.size() - i < 4096 ? x.size() - i : 4096);
+    }
+    double ns2 = (now_ns() - t0) / x.size();
+    keep(batch.Quantile(0.5f));
+
+    std::cout << bins << "\t" << ns1 << "\t" << ns2 << "\t" << single.Quantile(0.99f) << "\t"
+              << batch.Quantile(0.99f) << "\n";
+}
+
+int main() {
+    std::vector<float> x(SAMPLES);
+    BenchRng rng;
+    for (auto &v : x) v = float(rng.uniform() * rng.uniform()); // skewed towards 0
+
+    std::cout << "bins\tPush ns/sample\tbatch Push ns/sample\tq99 single\tq99 batch\n";
+    run(32, x);
+    run(64, x);
+    run(256, x);
+    return 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// helpers shared by the benchmark programs
+
+#include <chrono>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static inline double now_ns(void) {
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// cycle counter where the host has one (TSC), else nanoseconds
+static inline uint64_t cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(now_ns());
+#endif
+}
+
+// keep the compiler from discarding a result or hoisting work out of the timed loop
+template <typename T>
+static inline void keep(T const &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// deterministic fast generator for benchmark input (xorshift64*)
+struct BenchRng {
+    uint64_t s;
+    explicit BenchRng(uint64_t seed = 0x2545F4914F6CDD1DULL) : s(seed) {}
+    uint64_t next() {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return s * 0x2545F4914F6CDD1DULL;
+    }
+    // uniform in [0, 1)
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
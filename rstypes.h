@@ -12,4 +12,32 @@
 
 #ifndef _counter_t
 #define _counter_t uint32_t
-#endif
\ No newline at end of file
+#endif
+
+/**
+  * Accumulation mode for float data riding on a large offset (timestamps,
+    absolute pressures), where the mean and second moment lose most digits:
+      RS_SHIFTED      accumulate x - K, K being the first sample pushed
+      RS_COMPENSATED  Kahan-compensate the mean and second moment sums
+    modes may be combined, e.g.
+    <tt><b>#define RS_ACCUMULATE (RS_SHIFTED | RS_COMPENSATED)</b></tt>
+    before including. Applies to RunningStats; RollingVariance takes the mode
+    as template parameter, defaulting to RS_ACCUMULATE.
+    Compensation does not survive -ffast-math.
+  */
+#define RS_PLAIN 0
+#define RS_SHIFTED 1
+#define RS_COMPENSATED 2
+
+#ifndef RS_ACCUMULATE
+#define RS_ACCUMULATE RS_PLAIN
+#endif
+
+// one Kahan summation step, the compensated total is sum - c
+template <typename T>
+static inline void rs_kahan_add(T &sum, T &c, T x) {
+    T y = x - c;
+    T t = sum + y;
+    c = (t - sum) - y;
+    sum = t;
+}
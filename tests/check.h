@@ -0,0 +1,13 @@
+#pragma once
+
+// shared fixture of the test programs: check() prints Passed:/Failed: per
+// condition, main() returns failures ? 1 : 0 so ctest sees the result
+
+#include <iostream>
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    std::cout << (ok ? "Passed: " : "Failed: ") << what << "\n";
+    if (!ok) failures++;
+}
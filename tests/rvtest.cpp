@@ -1,5 +1,7 @@
 #include <iostream>
+#include <cmath>
 #include "RollingVariance.hpp"
+#include "check.h"
 
 int main() {
     RollingVariance<double> rv(5); 
@@ -10,6 +12,7 @@ int main() {
     rv.Push(3.0);
     std::cout << "Mean: " << rv.Mean() << "\n";     // Should be 3.0
     std::cout << "Variance: " << rv.Variance() << "\n"; // Should be 0
+    check(std::fabs(rv.Mean() - 3.0) < 1e-12 && std::fabs(rv.Variance()) < 1e-12, "constant window");
 
     rv.Clear();
     rv.Push(-2);
@@ -19,6 +22,7 @@ int main() {
     rv.Push(2);
     std::cout << "Mean: " << rv.Mean() << "\n";     // Should be 0
     std::cout << "Variance: " << rv.Variance() << "\n"; // Should be 2.0
+    check(std::fabs(rv.Mean()) < 1e-12 && std::fabs(rv.Variance() - 2.0) < 1e-12, "window after Clear()");
 
 
     RollingVariance<float> rv_float(2); // Using float
@@ -26,6 +30,7 @@ int main() {
     rv_float.Push(5.5f);
     std::cout << "Mean: " << rv_float.Mean() << "\n";     // Should be 5.0
     std::cout << "Variance: " << rv_float.Variance() << "\n"; // Should be 0.25
+    check(std::fabs(rv_float.Mean() - 5.0f) < 1e-6f && std::fabs(rv_float.Variance() - 0.25f) < 1e-6f, "float window");
 
-    return 0;
+    return failures ? 1 : 0;
 }
@@ -0,0 +1,59 @@
+// built with RS_ACCUMULATE=(RS_SHIFTED|RS_COMPENSATED), see CMakeLists.txt
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include "RollingVariance.hpp"
+#include "RunningStats.hpp"
+#include "check.h"
+
+int main() {
+    // samples 1e5 + {0, 0.25, 0.5, 0.75} repeated: variance 0.078125 (window of 4)
+    std::vector<float> x;
+    for (int i = 0; i < 100000; i++) x.push_back(1.0e5f + 0.25f * (i % 4));
+
+    RollingVariance<float, RS_PLAIN> plain(4);
+    RollingVariance<float, RS_SHIFTED | RS_COMPENSATED> shifted(4);
+    for (float v : x) {
+        plain.Push(v);
+        shifted.Push(v);
+    }
+    std::cout << "plain variance: " << plain.Variance() << " shifted: " << shifted.Variance() << "\n";
+    check(std::fabs(shifted.Variance() - 0.078125f) < 1e-6f, "shifted RollingVariance keeps precision");
+    check(std::fabs(shifted.Mean() - 100000.375f) < 1e-2f, "shifted RollingVariance mean");
+
+    // shifted mode primes the window with the first sample
+    RollingVariance<double, RS_SHIFTED> primed(3);
+    primed.Push(10.0);
+    check(primed.Mean() == 10.0 && primed.Variance() == 0.0, "first sample primes the window");
+
+    // RunningStats shifts by its first sample, merging rebases
+    RunningStats a, b, all;
+    for (int i = 0; i < 1000; i++) {
+        float v = 5.0e4f + 0.5f * (i % 7);
+        (i < 300 ? a : b).Push(v);
+        all.Push(v);
+    }
+    RunningStats c = a + b;
+    std::cout << "merged mean " << c.Mean() << " variance " << c.Variance()
+              << ", single mean " << all.Mean() << " variance " << all.Variance() << "\n";
+    check(c.NumDataValues() == 1000 && std::fabs(c.Mean() - all.Mean()) < 1e-2f &&
+          std::fabs(c.Variance() - all.Variance()) < 1e-4f, "merge of shifted RunningStats");
+    RunningStats empty;
+    check((empty + a).NumDataValues() == 300 && std::fabs((empty + a).Mean() - a.Mean()) < 1e-3f,
+          "merge with an empty RunningStats");
+
+    // higher moments of a merge with n^3 beyond the counter range
+    RunningStats big, small, seq;
+    for (int i = 0; i < 5000; i++) {
+        float v = (i < 4000 ? 1.0f : 2.0f) + 0.001f * float(i % 13) * float(i % 13);
+        (i < 4000 ? big : small).Push(v);
+        seq.Push(v);
+    }
+    RunningStats m = big + small;
+    std::cout << "merged skewness " << m.Skewness() << " kurtosis " << m.Kurtosis()
+              << ", single " << seq.Skewness() << " " << seq.Kurtosis() << "\n";
+    check(std::fabs(m.Skewness() - seq.Skewness()) < 1e-2f && std::fabs(m.Kurtosis() - seq.Kurtosis()) < 1e-2f,
+          "skewness and kurtosis of an unequal merge");
+
+    return failures ? 1 : 0;
+}
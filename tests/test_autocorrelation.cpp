@@ -0,0 +1,90 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include "RunningAutocorrelation.hpp"
+#include "check.h"
+
+// offline ACF, 1/n normalized
+static std::vector<double> brute(const std::vector<double> &x, size_t lags) {
+    double m = 0;
+    for (double v : x) m += v;
+    m /= x.size();
+    std::vector<double> c(lags + 1, 0.0);
+    for (size_t k = 0; k <= lags && k < x.size(); k++) {
+        for (size_t i = k; i < x.size(); i++) c[k] += (x[i] - m) * (x[i - k] - m);
+        c[k] /= x.size();
+    }
+    return c;
+}
+
+static double maxdiff(const std::vector<double> &a, const std::vector<double> &b) {
+    double d = 0;
+    for (size_t i = 0; i < a.size(); i++) d = std::max(d, std::fabs(a[i] - b[i]));
+    return d;
+}
+
+int main() {
+    const size_t L = 32;
+    uint32_t s = 1;
+    std::vector<double> x(3000);
+    for (size_t i = 0; i < x.size(); i++) {
+        s = s * 1664525u + 1013904223u;
+        x[i] = 500 + 3 * std::sin(2 * M_PI * i / 20.0) + ((s >> 16) % 1000) / 1000.0;
+    }
+    std::vector<double> ref = brute(x, L), got(L + 1);
+
+    RunningAutocorrelation<double> ac(L);
+    ac.Push(x.data(), x.size());
+    ac.Autocovariances(got.data());
+    std::cout << "max error " << maxdiff(got, ref) << "\n";
+    check(maxdiff(got, ref) < 1e-9, "streaming autocovariance matches offline ACF");
+    check(std::fabs(ac.Autocovariance(7) - ref[7]) < 1e-9, "single lag query");
+    check(ac.Autocorrelation(20) > 0.8 && ac.Autocorrelation(10) < -0.8, "period of 20 samples");
+
+    // short streams, fewer samples than lags
+    RunningAutocorrelation<double> sh(L);
+    std::vector<double> few(x.begin(), x.begin() + 5);
+    sh.Push(few.data(), few.size());
+    sh.Autocovariances(got.data());
+    check(maxdiff(got, brute(few, L)) < 1e-9, "fewer samples than lags");
+
+    // segments of any length joined with operator+ equal one stream
+    bool ok = true;
+    for (size_t cut : {1, 3, 32, 40, 1500}) {
+        RunningAutocorrelation<double> a(L), b(L), c(L);
+        a.Push(x.data(), cut);
+        b.Push(x.data() + cut, 10);
+        c.Push(x.data() + cut + 10, x.size() - cut - 10);
+        RunningAutocorrelation<double> sum = a + b + c;
+        sum.Autocovariances(got.data());
+        ok = ok && sum.NumDataValues() == x.size() && maxdiff(got, ref) < 1e-8 && std::fabs(sum.Mean() - ac.Mean()) < 1e-9;
+    }
+    check(ok, "operator+ of consecutive segments");
+
+    // merged estimator keeps streaming correctly
+    RunningAutocorrelation<double> m1(L), m2(L);
+    m1.Push(x.data(), 100);
+    m2.Push(x.data() + 100, 7);
+    m1 += m2;
+    m1.Push(x.data() + 107, x.size() - 107);
+    m1.Autocovariances(got.data());
+    check(maxdiff(got, ref) < 1e-8, "push after merge");
+
+    // FFT blocks
+    RunningAutocorrelation<double> fb(L);
+    fb.PushBlock(x.data(), 1000);
+    fb.PushBlock(x.data() + 1000, 20);
+    fb.Push(x.data() + 1020, 980);
+    fb.PushBlock(x.data() + 2000, 1000);
+    fb.Autocovariances(got.data());
+    std::cout << "FFT max error " << maxdiff(got, ref) << "\n";
+    check(maxdiff(got, ref) < 1e-6, "FFT block mode");
+
+    // float on an offset stays usable thanks to the shift
+    RunningAutocorrelation<float> af(L);
+    for (double v : x) af.Push(float(v));
+    std::cout << "float r(20) " << af.Autocorrelation(20) << "\n";
+    check(std::fabs(af.Autocorrelation(20) - ref[20] / ref[0]) < 1e-3, "float with offset");
+
+    return failures ? 1 : 0;
+}
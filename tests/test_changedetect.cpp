@@ -0,0 +1,58 @@
+#include <iostream>
+#include <vector>
+#include "ChangeDetector.hpp"
+#include "check.h"
+
+// deterministic noise in [-0.5, 0.5)
+static _float_t noise(uint32_t &s) {
+    s = s * 1664525u + 1013904223u;
+    return (s >> 8) / 16777216.0 - 0.5;
+}
+
+// index of the first event, -1 if none before the step, and its direction
+template <typename D>
+static void run(D &d, const char *name, change_t expect) {
+    uint32_t s = 1;
+    int first = -1;
+    change_t kind = CHANGE_NONE;
+    for (int i = 0; i < 600; i++) {
+        _float_t x = noise(s) + (i >= 400 ? (expect == CHANGE_UP ? 3.0 : -3.0) : 0.0);
+        change_t e = d.Push(x);
+        if (e != CHANGE_NONE && first < 0) {
+            first = i;
+            kind = e;
+        }
+    }
+    std::cout << name << " first event at " << first << "\n";
+    check(first >= 400 && first < 420 && kind == expect, name);
+}
+
+int main() {
+    ZScoreDetector z(0.05, 4.0);
+    run(z, "z-score step up", CHANGE_UP);
+    CusumDetector c(0.5, 10.0);
+    run(c, "CUSUM step down", CHANGE_DOWN);
+    PageHinkley ph(0.05, 20);
+    run(ph, "Page-Hinkley step up", CHANGE_UP);
+
+    // 1000 channels, a spike on channel 123 only
+    DetectorBank<ZScoreDetector> bank(1000, ZScoreDetector(0.05, 6.0));
+    std::vector<_float_t> frame(bank.Channels());
+    std::vector<change_t> events(bank.Channels());
+    uint32_t s = 7;
+    size_t before = 0;
+    for (int t = 0; t < 200; t++) {
+        for (auto &x : frame) x = noise(s);
+        before += bank.Push(frame.data(), events.data());
+    }
+    for (auto &x : frame) x = noise(s);
+    frame[123] = 10.0;
+    size_t hit = 0, where = 0;
+    size_t n = bank.Push(frame.data(), [&](size_t ch, change_t e) {
+        hit += e == CHANGE_UP;
+        where = ch;
+    });
+    check(before == 0 && n == 1 && hit == 1 && where == 123, "bank flags the spiking channel only");
+
+    return failures ? 1 : 0;
+}
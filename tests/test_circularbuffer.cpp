@@ -1,39 +1,43 @@
 #include <iostream>
+#include <vector>
 #include "CircularBuffer.hpp"
+#include "check.h"
+
+static std::vector<int> contents(const CircularBuffer<int> &cb) {
+    std::vector<int> v;
+    for (int val : cb) v.push_back(val);
+    return v;
+}
 
 int main() {
     CircularBuffer<int> cb(3);
-    
+    check(cb.empty() && cb.size() == 0 && cb.capacity() == 3, "empty buffer");
+
     // Push elements (will overwrite when full)
     cb.push(1);
     cb.push(2);
     cb.push(3);
-    std::cout << "After 3 pushes, size: " << cb.size() << "\n";  // Prints 3
-    
+    std::cout << "After 3 pushes, size: " << cb.size() << "\n";
+    check(cb.size() == 3 && cb.isFull(), "full after 3 pushes");
+
     cb.push(4);  // Overwrites 1
-    std::cout << "After 4th push, size: " << cb.size() << "\n";  // Still 3
-    
-    // Print all elements
-    std::cout << "Values: ";
-    for (int val : cb) {
-        std::cout << val << " ";  // Prints 2 3 4
-    }
-    std::cout << "\n";
-    
+    std::cout << "After 4th push, size: " << cb.size() << "\n";
+    check(cb.size() == 3 && cb.front() == 2, "4th push overwrites the oldest");
+    check(contents(cb) == std::vector<int>({2, 3, 4}), "iteration oldest first");
+
     // Pop elements
+    std::vector<int> popped;
     int value;
     while (cb.pop(value)) {
-        std::cout << "Popped: " << value << "\n";  // Prints 2, 3, 4
+        std::cout << "Popped: " << value << "\n";
+        popped.push_back(value);
     }
-    
+    check(popped == std::vector<int>({2, 3, 4}) && cb.empty(), "pop in order until empty");
+
     // Push more after empty
     cb.push(5);
     cb.push(6);
-    std::cout << "New values: ";
-    for (int val : cb) {
-        std::cout << val << " ";  // Prints 5 6
-    }
-    std::cout << "\n";
+    check(contents(cb) == std::vector<int>({5, 6}) && !cb.isFull(), "push after empty");
 
-    return 0;
-}
\ No newline at end of file
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Downsampler.hpp"
+#include "check.h"
+
+int main() {
+    std::vector<_float_t> x(1000);
+    for (size_t i = 0; i < x.size(); i++) {
+        x[i] = 10 + 5 * std::sin(0.05 * i) + (i % 7);
+    }
+
+    // per 100 samples, single pushes
+    Downsampler ds(100);
+    std::vector<DownsampleSummary> single;
+    for (_float_t v : x) {
+        if (ds.Push(v)) single.push_back(ds.Last());
+    }
+    check(single.size() == 10 && !ds.Flush(), "one summary per 100 samples");
+
+    const DownsampleSummary &s = single[3];
+    auto b = x.begin() + 300, e = x.begin() + 400;
+    double sum = 0, sq = 0;
+    for (auto it = b; it != e; ++it) sum += *it;
+    double mean = sum / 100;
+    for (auto it = b; it != e; ++it) sq += (*it - mean) * (*it - mean);
+    std::cout << "mean " << s.mean << " / " << mean << ", variance " << s.variance << " / " << sq / 99 << "\n";
+    check(s.count == 100 && s.start == 300 && s.end == 399 && s.first == x[300] && s.last == x[399] &&
+          s.min == *std::min_element(b, e) && s.max == *std::max_element(b, e), "count, bounds, first, last");
+    check(std::fabs(s.mean - mean) < 1e-4 && std::fabs(s.variance - sq / 99) < 1e-3, "mean and variance");
+
+    // batch and CircularBuffer input give the same summaries
+    Downsampler db(100);
+    std::vector<DownsampleSummary> batch;
+    auto keep = [&](const DownsampleSummary &r) { batch.push_back(r); };
+    db.Push(x.data(), 250, keep);
+    CircularBuffer<_float_t> cb(750);
+    for (size_t i = 250; i < x.size(); i++) cb.push(x[i]);
+    db.Push(cb, keep);
+    bool same = batch.size() == single.size();
+    for (size_t i = 0; same && i < batch.size(); i++) {
+        same = batch[i].mean == single[i].mean && batch[i].max == single[i].max && batch[i].end == single[i].end;
+    }
+    check(same, "batch and CircularBuffer input");
+
+    // timestamps at 1 kHz in us, summaries aligned to whole seconds
+    Downsampler dt(0, 1000000);
+    std::vector<DownsampleSummary> secs;
+    for (uint64_t i = 0; i < 3500; i++) {
+        if (dt.Push(1234567 + i * 1000, _float_t(i))) secs.push_back(dt.Last());
+    }
+    check(dt.Flush(), "flush of the open interval");
+    secs.push_back(dt.Last());
+    std::cout << "intervals " << secs.size() << ": " << secs[0].count << " " << secs[1].count << " "
+              << secs[3].count << "\n";
+    check(secs.size() == 4 && secs[0].count == 766 && secs[1].count == 1000 && secs[1].start == 2000567 &&
+          secs[3].count == 734, "interval summaries aligned to the interval");
+
+    // LTTB keeps the first sample, the last sample and a spike
+    std::vector<_float_t> y(1000);
+    for (size_t i = 0; i < y.size(); i++) y[i] = std::sin(0.01 * i);
+    y[517] = 50;
+    LttbDownsampler lt(50);
+    std::vector<LttbPoint> pts;
+    for (_float_t v : y) {
+        if (lt.Push(v)) pts.push_back(lt.Last());
+    }
+    lt.Flush([&](const LttbPoint &p) { pts.push_back(p); });
+    bool spike = false;
+    for (auto &p : pts) spike = spike || (p.t == 517 && p.x == 50);
+    std::cout << "LTTB points " << pts.size() << "\n";
+    check(pts.size() == 22 && pts.front().t == 0 && pts.back().t == 999, "LTTB keeps first and last sample");
+    check(spike, "LTTB keeps the spike");
+    bool ordered = true;
+    for (size_t i = 1; i < pts.size(); i++) ordered = ordered && pts[i].t > pts[i - 1].t;
+    check(ordered, "LTTB points in time order");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include "FixedPoint.hpp"
+#include "RunningVariance.hpp"
+#include "check.h"
+
+int main() {
+    // 12 bit ADC counts on an offset, Q0: the integer sums are exact
+    uint32_t s = 7;
+    std::vector<int32_t> x(5000);
+    for (auto &v : x) {
+        s = s * 1664525u + 1013904223u;
+        v = 100000 + int32_t((s >> 20) & 0xfff);
+    }
+
+    FixedRunningVariance<0> fv;
+    RunningVariance<double> ref;
+    for (int32_t v : x) {
+        fv.Push(v);
+        ref.Push(v);
+    }
+    std::cout << "mean " << fv.Mean() << " / " << ref.Mean()
+              << ", variance " << fv.Variance() << " / " << ref.Variance() << "\n";
+    check(fv.NumDataValues() == x.size(), "count");
+    check(std::fabs(fv.Mean() - ref.Mean()) <= 0.501, "running mean within rounding");
+    check(std::fabs(fv.Variance() - ref.Variance()) <= 1.0, "running variance within rounding");
+    check(std::fabs(fv.StandardDeviation() - std::sqrt(ref.Variance())) < 1.0, "running standard deviation");
+
+    // Q16 values
+    FixedRunningVariance<16> fq;
+    RunningVariance<double> rq;
+    for (int i = 0; i < 1000; i++) {
+        double v = -3.0 + 0.25 * std::sin(0.1 * i);
+        fq.Push(rs_to_fixed<16>(v));
+        rq.Push(v);
+    }
+    double fm = rs_from_fixed<16>(fq.Mean());
+    double fs = rs_from_fixed<16>(fq.StandardDeviation());
+    std::cout << "Q16 mean " << fm << " / " << rq.Mean() << ", sd " << fs << " / " << std::sqrt(rq.Variance()) << "\n";
+    check(std::fabs(fm - rq.Mean()) < 1e-4 && std::fabs(fs - std::sqrt(rq.Variance())) < 1e-4, "Q16 mean and standard deviation");
+
+    // windowed sums match a recomputation over the window at every step
+    for (size_t w : {1, 4, 64}) {
+        FixedRollingVariance<0> frv(w);
+        bool ok = true;
+        for (size_t i = 0; i < 1000; i++) {
+            frv.Push(x[i]);
+            size_t begin = i + 1 > w ? i + 1 - w : 0;
+            RunningVariance<double> win;
+            for (size_t j = begin; j <= i; j++) win.Push(x[j]);
+            double n = double(i + 1 - begin);
+            double pvar = win.Variance() * (n - 1) / n;
+            ok = ok && std::fabs(frv.Mean() - win.Mean()) <= 0.501 && std::fabs(frv.Variance() - pvar) <= 1.0;
+        }
+        std::cout << "W=" << w << " ";
+        check(ok, "rolling window matches recomputation");
+    }
+
+    // alpha = 1/8: first sample primes, a step settles exactly on the new level
+    FixedExponentialSmoothing<8> fes(3);
+    fes.Push(rs_to_fixed<8>(1.0));
+    check(fes.Value() == 256, "smoothing primed by first sample");
+    int32_t prev = fes.Value();
+    bool monotonic = true;
+    for (int i = 0; i < 200; i++) {
+        int32_t v = fes.Smooth(rs_to_fixed<8>(-2.0));
+        monotonic = monotonic && v <= prev;
+        prev = v;
+    }
+    check(monotonic && fes.Value() == rs_to_fixed<8>(-2.0), "smoothing settles on a step");
+    // negative state through a shift change
+    fes.setShift(5);
+    check(fes.Value() == rs_to_fixed<8>(-2.0), "setShift keeps a negative value");
+    fes.Push(rs_to_fixed<8>(-2.0));
+    check(fes.Value() == rs_to_fixed<8>(-2.0), "negative value steady after setShift");
+
+    // deviations past 2^31.5, whose square overflows int64_t
+    FixedRunningVariance<0> wide;
+    wide.Push(-2000000000);
+    wide.Push(1500000000);
+    check(wide.Variance() == 6125000000000000000LL, "variance of a 3.5e9 wide pair");
+    FixedRollingVariance<0> wideWin(2);
+    for (int i = 0; i < 5; i++) wideWin.Push(i & 1 ? 1500000000 : -2000000000);
+    check(wideWin.Variance() == 3062500000000000000LL, "rolling variance (n denominator) of a 3.5e9 wide pair");
+
+    // the int32_t extremes: variance past 2^63, standard deviation past 2^31
+    FixedRunningVariance<0> extreme;
+    FixedRollingVariance<0> extremeWin(3);
+    for (int32_t x : {INT32_MIN, INT32_MAX, INT32_MIN}) {
+        extreme.Push(x);
+        extremeWin.Push(x);
+    }
+    std::cout << "extremes: variance " << extreme.Variance() << ", sd " << extreme.StandardDeviation() << "\n";
+    check(extreme.Variance() == 6148914688373205675ULL && extreme.StandardDeviation() == 2479700523u,
+          "variance and standard deviation at the int32_t extremes");
+    check(extremeWin.Variance() == 4099276458915470450ULL && extremeWin.StandardDeviation() == 2024666999u,
+          "rolling variance and standard deviation at the int32_t extremes");
+
+    check(FixedExponentialSmoothing<8>::ShiftForAlpha(0.125) == 3 &&
+          FixedExponentialSmoothing<8>::ShiftForAlpha(0.1) == 3, "shift for alpha");
+
+    check(rs_isqrt64(0) == 0 && rs_isqrt64(99) == 9 && rs_isqrt64(100) == 10 &&
+          rs_isqrt64(~uint64_t(0)) == 0xffffffffu, "integer square root");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include "KalmanFilter.hpp"
+#include "RunningStats.hpp"
+#include "check.h"
+
+// deterministic noise, uniform with the given standard deviation
+static uint32_t seed = 11;
+static double noise(double sd) {
+    seed = seed * 1664525u + 1013904223u;
+    return sd * std::sqrt(12.0) * (double(seed >> 8) / 16777216.0 - 0.5);
+}
+
+int main() {
+    // level: filtered error well below the measurement noise
+    KalmanFilter<1, double> level(1e-6, 0.25);
+    RunningStats raw, filtered;
+    for (int i = 0; i < 5000; i++) {
+        double z = 3.0 + noise(0.5);
+        double y = level.Push(z);
+        if (i > 500) {
+            raw.Push(z - 3.0);
+            filtered.Push(y - 3.0);
+        }
+    }
+    std::cout << "raw sd " << raw.StandardDeviation() << ", filtered sd " << filtered.StandardDeviation() << "\n";
+    check(filtered.StandardDeviation() < 0.1 * raw.StandardDeviation(), "level filter reduces noise");
+
+    // constant velocity on a ramp: slope from the second state
+    const double dt = 0.01;
+    KalmanFilter<2, double> cv(0, 0.04);
+    double F[2][2] = {{1, dt}, {0, 1}};
+    double Q[2][2] = {{1e-8, 0}, {0, 1e-6}};
+    cv.SetTransition(F);
+    cv.SetProcessNoise(Q);
+    for (int i = 0; i < 3000; i++) cv.Push(1.0 + 2.5 * i * dt + noise(0.2));
+    std::cout << "velocity " << cv.State(1) << ", position " << cv.State(0) << "\n";
+    check(std::fabs(cv.State(1) - 2.5) < 0.05 && std::fabs(cv.State(0) - (1.0 + 2.5 * 2999 * dt)) < 0.1,
+          "constant velocity tracks a ramp");
+    check(std::fabs(cv.Covariance(0, 1) - cv.Covariance(1, 0)) < 1e-12, "covariance stays symmetric");
+
+    // bank channels match single filters, including a partial lane block
+    const size_t channels = 37;
+    KalmanFilter<2, float> proto(0, 0.04f);
+    float Ff[2][2] = {{1, 0.01f}, {0, 1}};
+    float Qf[2][2] = {{1e-6f, 0}, {0, 1e-4f}};
+    proto.SetTransition(Ff);
+    proto.SetProcessNoise(Qf);
+    KalmanBank<2, float> bank(channels, proto);
+    std::vector<KalmanFilter<2, float>> single(channels, proto);
+    std::vector<float> z(channels), out(channels);
+    bool same = true;
+    for (int t = 0; t < 500; t++) {
+        for (size_t c = 0; c < channels; c++) z[c] = float(c) + 0.1f * t + float(noise(0.2));
+        bank.Push(z.data(), out.data());
+        for (size_t c = 0; c < channels; c++) {
+            float v = single[c].Push(z[c]);
+            same = same && std::fabs(v - out[c]) < 1e-3f * (1 + std::fabs(v));
+        }
+    }
+    std::cout << "channel 36 " << out[36] << " / " << single[36].Value() << "\n";
+    check(same, "bank matches single filters");
+
+    // adaptive R converges to the measurement noise variance
+    AdaptiveKalmanFilter<1, double> ad(256, KalmanFilter<1, double>(1e-6, 10.0));
+    for (int i = 0; i < 20000; i++) ad.Push(-1.0 + noise(0.3));
+    std::cout << "estimated R " << ad.MeasurementNoise() << " (0.09)\n";
+    check(std::fabs(ad.MeasurementNoise() - 0.09) < 0.02, "adaptive measurement noise");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <cmath>
+#include <string>
+#include "KeyedStats.hpp"
+#include "RunningStats.hpp"
+#include "check.h"
+
+int main() {
+    KeyedStats<std::string_view, RunningStats> ks(1000);
+
+    for (int i = 0; i < 100; i++) {
+        std::string key = "endpoint" + std::to_string(i % 10);
+        ks.Push(key, _float_t(i % 10));
+        ks.Push(key, _float_t(i % 10 + 2));
+    }
+    check(ks.Size() == 10, "10 distinct keys");
+    const RunningStats *rs = ks.Find("endpoint3");
+    check(rs && rs->NumDataValues() == 20 && std::fabs(rs->Mean() - 4.0) < 1e-5, "endpoint3 mean 4");
+    check(ks.Find("endpoint10") == nullptr, "unknown key not found");
+
+    // precomputed hash goes to the same slot
+    uint64_t h = ks.Hash("endpoint3");
+    ks.PushHashed("endpoint3", h, 4.0);
+    check(ks.Find("endpoint3")->NumDataValues() == 21, "PushHashed hits the same key");
+
+    // idle keys are evicted, active ones kept
+    ks.SetMaxIdle(2);
+    for (int epoch = 0; epoch < 5; epoch++) {
+        ks.Push("busy", 1.0);
+        ks.Tick();
+    }
+    check(ks.Size() == 1 && ks.Find("busy") != nullptr, "only the busy key survives eviction");
+
+    // merging shards equals pushing everything into one table
+    KeyedStats<uint32_t, RunningStats> a(64), b(64), all(64);
+    for (uint32_t i = 0; i < 1000; i++) {
+        (i & 1 ? a : b).Push(i % 7, _float_t(i));
+        all.Push(i % 7, _float_t(i));
+    }
+    a.MergeFrom(b);
+    bool same = a.Size() == all.Size();
+    all.ForEach([&](uint32_t key, const RunningStats &s) {
+        const RunningStats *m = a.Find(key);
+        same = same && m && m->NumDataValues() == s.NumDataValues() &&
+               std::fabs(m->Mean() - s.Mean()) < 1e-3 * s.Mean();
+    });
+    check(same, "MergeFrom matches single table");
+
+    // churn through a small table and arena, keys get evicted and their bytes reclaimed
+    KeyedStats<std::string, RunningStats> small(16, 16 * 12);
+    bool ok = true;
+    for (int i = 0; i < 10000; i++) {
+        if (small.Size() == small.Capacity()) {
+            small.Tick();
+            small.EvictIdle(0);
+        }
+        ok = ok && small.Push("key-" + std::to_string(i), 1.0);
+    }
+    check(ok, "bounded table keeps accepting keys with eviction");
+    check(small.Find("key-9999") != nullptr, "most recent key present");
+
+    // a full arena with few erased bytes rejects new keys without compacting
+    KeyedStats<std::string, RunningStats> arena(8, 8 * 9);
+    for (int i = 0; i < 8; i++) arena.Push("key-" + std::to_string(100000 + i).substr(1), 1.0);
+    arena.Erase("key-00000");
+    check(!arena.Push("key-99999", 1.0), "arena with 1/8 erased rejects a new key");
+    check(arena.Find("key-00007") != nullptr, "live keys intact after rejection");
+    for (int i = 1; i < 4; i++) arena.Erase("key-" + std::to_string(100000 + i).substr(1));
+    check(arena.Push("key-99999", 1.0), "arena with half erased compacts and accepts");
+    bool intact = true;
+    for (int i = 4; i < 8; i++) intact = intact && arena.Find("key-" + std::to_string(100000 + i).substr(1));
+    check(intact && arena.Find("key-99999"), "keys readable after compaction");
+
+    KeyedStats<uint32_t, RunningStats> full(4);
+    for (uint32_t i = 0; i < 4; i++) full.Push(i, 1.0);
+    check(!full.Push(99u, 1.0), "full table rejects new key");
+    check(full.Push(2u, 1.0), "full table accepts existing key");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <cmath>
+#include <string.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MetricsExporter.hpp"
+#include "RunningStats.hpp"
+#include "RunningVariance.hpp"
+#include "SeqlockStats.hpp"
+#include "check.h"
+
+static std::string prometheus(const MetricsExporter &ex) {
+    std::string s(ex.RenderPrometheus(nullptr, 0), '\0');
+    ex.RenderPrometheus(&s[0], s.size() + 1);
+    return s;
+}
+
+static std::string json(const MetricsExporter &ex) {
+    std::string s(ex.RenderJson(nullptr, 0), '\0');
+    ex.RenderJson(&s[0], s.size() + 1);
+    return s;
+}
+
+int main() {
+    RunningStats get, put;
+    RunningVariance<double> rv;
+    SeqlockStats<RunningStats> loop;
+    for (int i = 1; i <= 4; i++) {
+        get.Push(i);
+        rv.Push(0.5 * i);
+        loop.Push(10);
+    }
+    put.Push(2.5);
+
+    MetricsExporter ex;
+    ex.Add("http_latency_us", get, {{"endpoint", "get"}});
+    ex.Add("loop period", loop);
+    ex.Add("http_latency_us", put, {{"endpoint", "put\"x\""}});
+    ex.Add("ratio", rv, {{"a", "1"}, {"b", "2"}});
+    ex.Capture();
+
+    std::string p = prometheus(ex);
+    std::cout << p;
+    const char *expected =
+        "# TYPE http_latency_us summary\n"
+        "http_latency_us_count{endpoint=\"get\"} 4\n"
+        "http_latency_us_count{endpoint=\"put\\\"x\\\"\"} 1\n"
+        "http_latency_us_sum{endpoint=\"get\"} 10\n"
+        "http_latency_us_sum{endpoint=\"put\\\"x\\\"\"} 2.5\n"
+        "# TYPE http_latency_us_mean gauge\n"
+        "http_latency_us_mean{endpoint=\"get\"} 2.5\n"
+        "http_latency_us_mean{endpoint=\"put\\\"x\\\"\"} 2.5\n"
+        "# TYPE http_latency_us_stddev gauge\n";
+    check(p.compare(0, strlen(expected), expected) == 0, "prometheus families grouped by name, labels escaped");
+    check(p.find("# TYPE loop_period summary\nloop_period_count 4\nloop_period_sum 40\n") != std::string::npos,
+          "name sanitized, seqlock series read via snapshot");
+    check(p.find("ratio_mean{a=\"1\",b=\"2\"} 1.25\n") != std::string::npos, "multiple labels");
+
+    std::string j = json(ex);
+    std::cout << j;
+    const char *head = "{\"metrics\":[{\"name\":\"http_latency_us\",\"labels\":{\"endpoint\":\"get\"},\"count\":4,\"mean\":2.5,";
+    check(j.compare(0, strlen(head), head) == 0 &&
+          j.find("{\"name\":\"loop_period\",\"labels\":{},\"count\":4,\"mean\":10,\"stddev\":0}") != std::string::npos &&
+          j.back() == '\n', "json");
+
+    // values are those of the last Capture(), not of the live accumulators
+    get.Push(1000);
+    check(prometheus(ex) == p, "render formats the captured values only");
+    ex.Capture();
+    check(ex.Captured(0).count == 5 && prometheus(ex) != p, "capture picks up new values");
+
+    // truncation reports the full length and keeps the buffer terminated
+    char small[32];
+    size_t n = ex.RenderPrometheus(small, sizeof(small));
+    check(n == prometheus(ex).size() && strlen(small) == sizeof(small) - 1 &&
+          prometheus(ex).compare(0, sizeof(small) - 1, small) == 0, "truncated output");
+
+    // an empty accumulator renders as zeros, non-finite json values as null
+    RunningStats empty;
+    MetricsExporter ex2;
+    ex2.Add("idle", empty);
+    ex2.Capture();
+    check(prometheus(ex2).find("idle_count 0\nidle_sum 0\n") != std::string::npos, "empty series");
+    check(json(ex2).find("\"stddev\":0") != std::string::npos, "empty series json");
+
+    // control characters in label values, a colon in a label name
+    MetricsExporter esc;
+    esc.Add("job:rate", empty, {{"host:port", "a\tb\r\x01\n\"\\"}});
+    esc.Capture();
+    check(prometheus(esc).find("job:rate_count{host_port=\"a\tb\r\x01\\n\\\"\\\\\"} 0\n") != std::string::npos,
+          "prometheus label name without colon, value escapes");
+    check(json(esc).find("\"labels\":{\"host:port\":\"a\\u0009b\\u000d\\u0001\\n\\\"\\\\\"}") != std::string::npos,
+          "json escapes every control character");
+
+    // the writers' mutex makes each capture one cut across series: requests
+    // and bytes are always pushed together, so their counts must agree
+    std::mutex statsLock;
+    RunningStats requests, bytes;
+    MetricsExporter ex3(statsLock);
+    ex3.Add("requests", requests);
+    ex3.Add("bytes", bytes);
+    const uint64_t N = 200000;
+    std::thread writer([&] {
+        for (uint64_t i = 1; i <= N; i++) {
+            std::lock_guard<std::mutex> g(statsLock);
+            requests.Push(1);
+            bytes.Push(_float_t(i % 1500));
+        }
+    });
+    uint64_t captures = 0, torn = 0;
+    for (;;) {
+        ex3.Capture();
+        captures++;
+        torn += ex3.Captured(0).count != ex3.Captured(1).count;
+        if (ex3.Captured(0).count == N) break;
+    }
+    writer.join();
+    std::cout << captures << " concurrent captures\n";
+    check(torn == 0, "captures under the writers' mutex are consistent across series");
+
+    return failures ? 1 : 0;
+}
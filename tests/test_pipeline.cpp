@@ -0,0 +1,59 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include "Pipeline.hpp"
+#include "check.h"
+
+int main() {
+    // a short known sequence: a step with some noise
+    std::vector<_float_t> x;
+    for (int i = 0; i < 40; i++) x.push_back(_float_t(i < 20 ? 1.0 : 3.0) + _float_t(0.125 * ((i * 7) % 5)));
+
+    // the same chain built from the standalone classes
+    ExponentialSmoothing es(0.25);
+    RollingVariance<_float_t> rv(4);
+    RunningStats rs;
+    std::vector<_float_t> smoothed, variance;
+    size_t passed = 0;
+    for (_float_t v : x) {
+        _float_t s = es.Smooth(v);
+        rv.Push(s);
+        _float_t var = rv.Variance();
+        smoothed.push_back(s);
+        variance.push_back(var);
+        if (var > _float_t(0.01) && var < _float_t(0.5)) {
+            rs.Push(var);
+            passed++;
+        }
+    }
+
+    // lambda stages record what the stage before them produced
+    std::vector<_float_t> gotSmoothed, gotVariance, gotPassed;
+    auto p = pipe(Smooth(0.25), [&](_float_t &v) { gotSmoothed.push_back(v); return true; },
+                  RollingVar<4>(), [&](_float_t &v) { gotVariance.push_back(v); return true; },
+                  Above(0.01), Below(0.5), [&](_float_t &v) { gotPassed.push_back(v); return true; },
+                  Stats());
+
+    size_t n = 0;
+    for (size_t i = 0; i < 10; i++) n += p.Push(x[i]);
+    n += p.Push(x.data() + 10, x.size() - 10);
+
+    check(gotSmoothed == smoothed, "Smooth stage matches ExponentialSmoothing");
+    check(gotVariance == variance, "RollingVar stage matches RollingVariance");
+    check(n == passed && gotPassed.size() == passed, "Above/Below pass the samples inside the band");
+    bool inside = true;
+    for (_float_t v : gotPassed) inside = inside && v > _float_t(0.01) && v < _float_t(0.5);
+    check(inside, "only samples inside the band reach later stages");
+    check(passed > 0 && passed < x.size(), "band drops some samples and keeps some");
+
+    RunningStats &st = p.get<7>();
+    check(st.NumDataValues() == rs.NumDataValues() && st.Mean() == rs.Mean() && st.Variance() == rs.Variance(),
+          "Stats stage matches RunningStats");
+    check(p.get<0>().Value() == es.Value(), "stages are reachable through get<>()");
+
+    // a stage returning false stops the sample
+    auto none = pipe(Below(0), Stats());
+    check(none.Push(x.data(), x.size()) == 0 && none.get<1>().NumDataValues() == 0, "closed gate passes nothing");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include "QuadraticFitOnline.hpp"
+#include "check.h"
+
+int main() {
+    // y = 0.5 - 2 x + 3 x^2 plus deterministic noise of stddev ~0.01
+    const size_t n = 1024;
+    std::vector<float> x(n), y(n);
+    uint32_t s = 3;
+    for (size_t i = 0; i < n; i++) {
+        s = s * 1664525u + 1013904223u;
+        x[i] = float(i) / n;
+        y[i] = 0.5f - 2 * x[i] + 3 * x[i] * x[i] + 0.01f * std::sqrt(12.0f) * (float(s >> 8) / 16777216.0f - 0.5f);
+    }
+
+    QuadraticFitOnline seq, blk, two;
+    for (size_t i = 0; i < n; i++) seq.update(x[i], y[i]);
+    RunningStats res;
+    blk.update(x.data(), y.data(), n, &res);
+    two.update(x.data(), y.data(), 100);
+    two.update(x.data() + 100, y.data() + 100, n - 100);
+
+    Eigen::Vector3f a = seq.getCoefficients(), b = blk.getCoefficients(), c = two.getCoefficients();
+    std::cout << "sequential " << a.transpose() << ", batch " << b.transpose() << ", two blocks " << c.transpose() << "\n";
+    check((a - b).cwiseAbs().maxCoeff() < 1e-3f, "batch update matches sequential updates");
+    check((b - c).cwiseAbs().maxCoeff() < 1e-4f, "consecutive blocks match one block");
+    check(std::fabs(b[0] - 0.5f) < 0.01f && std::fabs(b[1] + 2) < 0.01f && std::fabs(b[2] - 3) < 0.01f,
+          "coefficients recovered");
+
+    // sequential updates continue from a batch
+    QuadraticFitOnline mix;
+    mix.update(x.data(), y.data(), 500);
+    for (size_t i = 500; i < n; i++) mix.update(x[i], y[i]);
+    check((mix.getCoefficients() - a).cwiseAbs().maxCoeff() < 1e-3f, "batch followed by single updates");
+
+    // a long run of small blocks on a wide x range, where P is tiny and
+    // badly conditioned, against the double least squares solution: the
+    // blocks only carry the float rounding of beta, the single updates also
+    // that of P
+    {
+        const size_t m = 200000;
+        std::vector<float> wx(m), wy(m);
+        Eigen::Matrix3d A = Eigen::Matrix3d::Zero();
+        Eigen::Vector3d r = Eigen::Vector3d::Zero();
+        for (size_t i = 0; i < m; i++) {
+            s = s * 1664525u + 1013904223u;
+            wx[i] = float(100.0 * (i % 5000) / 5000.0);
+            wy[i] = 0.5f - 2 * wx[i] + 0.03f * wx[i] * wx[i] + 0.01f * (float(s >> 8) / 16777216.0f - 0.5f);
+            Eigen::Vector3d v(1, wx[i], double(wx[i]) * wx[i]);
+            A += v * v.transpose();
+            r += v * double(wy[i]);
+        }
+        Eigen::Vector3d ref = A.ldlt().solve(r);
+        QuadraticFitOnline single, blocks;
+        for (size_t i = 0; i < m; i++) single.update(wx[i], wy[i]);
+        for (size_t i = 0; i < m; i += 16) blocks.update(wx.data() + i, wy.data() + i, 16);
+        Eigen::Array3d scale = 1 + ref.array().abs();
+        double eb = ((blocks.getCoefficients().cast<double>() - ref).array().abs() / scale).maxCoeff();
+        double es = ((single.getCoefficients().cast<double>() - ref).array().abs() / scale).maxCoeff();
+        std::cout << "wide range error: blocks " << eb << ", single " << es << "\n";
+        check(eb < 1e-5, "12500 blocks stay within 1e-5 of the double solution");
+        check(es < 1e-4, "single updates stay within 1e-4 of the double solution");
+    }
+
+    std::vector<float> p(n);
+    blk.predict(x.data(), p.data(), n);
+    bool same = true;
+    for (size_t i = 0; i < n; i++) same = same && std::fabs(p[i] - blk.predict(x[i])) < 1e-5f;
+    check(same, "batch predict matches predict");
+
+    std::cout << "residuals mean " << res.Mean() << " stddev " << res.StandardDeviation() << "\n";
+    check(res.NumDataValues() == n && std::fabs(res.Mean()) < 1e-3f && std::fabs(res.StandardDeviation() - 0.01f) < 1e-3f,
+          "residual statistics");
+
+    return failures ? 1 : 0;
+}
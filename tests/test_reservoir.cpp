@@ -0,0 +1,146 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include "Reservoir.hpp"
+#include "check.h"
+
+#define N 10000
+#define K 100
+#define TRIALS 2000
+
+// largest relative deviation of per-decile inclusion counts from uniform
+static double deviation(const std::vector<double> &deciles) {
+    double expect = double(TRIALS) * K / 10, worst = 0;
+    for (double c : deciles) worst = std::max(worst, std::fabs(c / expect - 1));
+    return worst;
+}
+
+int main() {
+    std::vector<uint32_t> items(N);
+    for (uint32_t i = 0; i < N; i++) items[i] = i;
+
+    // inclusion is uniform over the stream, per item and in batches
+    std::vector<double> single(10, 0), batch(10, 0), merged(10, 0);
+    bool sizes = true;
+    for (uint64_t seed = 1; seed <= TRIALS; seed++) {
+        Reservoir<uint32_t> r(K, seed), b(K, seed + 7919);
+        for (uint32_t x : items) r.Push(x);
+        b.Push(items.data(), 37);
+        b.Push(items.data() + 37, N - 37);
+        Reservoir<uint32_t> s1(K, seed * 3), s2(K, seed * 3 + 1);
+        s1.Push(items.data(), 3000);
+        s2.Push(items.data() + 3000, N - 3000);
+        Reservoir<uint32_t> m = s1 + s2;
+        sizes = sizes && r.Size() == K && b.Size() == K && m.Size() == K && r.Seen() == N && b.Seen() == N &&
+                m.Seen() == N;
+        for (size_t i = 0; i < K; i++) {
+            single[r[i] * 10 / N]++;
+            batch[b[i] * 10 / N]++;
+            merged[m[i] * 10 / N]++;
+        }
+    }
+    std::cout << "decile deviation: single " << deviation(single) << ", batch " << deviation(batch)
+              << ", merged " << deviation(merged) << "\n";
+    check(sizes, "sizes and counts");
+    // 20000 expected per decile, sd ~ 0.7%
+    check(deviation(single) < 0.03, "uniform inclusion, single pushes");
+    check(deviation(batch) < 0.03, "uniform inclusion, batch pushes");
+    check(deviation(merged) < 0.03, "uniform inclusion after merging unequal shards");
+
+    // the sample keeps evolving after a merge
+    Reservoir<uint32_t> s1(K, 5), s2(K, 6);
+    s1.Push(items.data(), N / 2);
+    s2.Push(items.data() + N / 2, N / 2);
+    Reservoir<uint32_t> m = s1 + s2;
+    std::vector<uint32_t> late(N);
+    for (uint32_t i = 0; i < N; i++) late[i] = N + i;
+    m.Push(late.data(), N);
+    size_t fromLate = 0;
+    for (uint32_t x : m.Samples()) fromLate += x >= N;
+    check(fromLate > 30 && fromLate < 70, "merged reservoir continues sampling");
+
+    // fewer items than k: all of them are kept
+    Reservoir<uint32_t> small(K);
+    small.Push(items.data(), 10);
+    Reservoir<uint32_t> both = small + small;
+    check(small.Size() == 10 && both.Size() == 20, "partially filled reservoirs");
+
+    // different capacities: the smaller one gives at most what it holds
+    Reservoir<uint32_t> big(100, 7), tiny(10, 8);
+    for (uint32_t i = 0; i < 1000; i++) {
+        big.Push(i);
+        tiny.Push(1000 + i);
+    }
+    Reservoir<uint32_t> bt = big + tiny, tb = tiny + big;
+    size_t fromTiny = 0;
+    for (uint32_t x : bt.Samples()) fromTiny += x >= 1000;
+    check(bt.Size() == 100 && fromTiny <= 10, "merge into a larger capacity");
+    check(tb.Size() == 10 && tb.Capacity() == 10, "merge into a smaller capacity");
+
+    // a short stream held whole plus a sample of a long one: the short one
+    // gets its share of the counts, not of the items, and the result samples
+    // on uniformly
+    std::vector<uint32_t> longStream(1000000);
+    for (uint32_t i = 0; i < longStream.size(); i++) longStream[i] = 1000 + i;
+    size_t fromShort = 0, fromShortRev = 0, held = 0, newer = 0;
+    bool valid = true;
+    for (int t = 0; t < 200; t++) {
+        Reservoir<uint32_t> whole(20, 3 * t + 1), sampled(5, 3 * t + 2);
+        for (uint32_t i = 0; i < 10; i++) whole.Push(i);
+        sampled.Push(longStream.data(), longStream.size());
+        Reservoir<uint32_t> ws = whole + sampled, sw = sampled + whole;
+        valid = valid && ws.Seen() == 1000010 && ws.Size() >= 1 && ws.Size() <= 5 && sw.Size() == 5;
+        for (uint32_t x : ws.Samples()) fromShort += x < 1000;
+        for (uint32_t x : sw.Samples()) fromShortRev += x < 1000;
+        size_t before = ws.Size();
+        for (uint32_t i = 0; i < 1000010; i++) ws.Push(2000000 + i);
+        valid = valid && ws.Size() == before;
+        held += ws.Size();
+        for (uint32_t x : ws.Samples()) newer += x >= 2000000;
+    }
+    std::cout << "short stream items " << fromShort << " / " << fromShortRev << ", newer share "
+              << double(newer) / held << "\n";
+    check(valid && fromShort <= 1 && fromShortRev <= 1, "merge of unequal capacity and fill weighs by counts");
+    check(std::fabs(double(newer) / held - 0.5) < 0.1, "smaller merged sample continues uniformly");
+
+    // k = 1 decaying reservoir: item t is kept with probability
+    // exp(alpha t) / sum exp(alpha s)
+    const double alpha = 0.01;
+    const int T = 400;
+    std::vector<double> hits(4, 0), hitsMerged(4, 0);
+    std::vector<uint64_t> ts(T);
+    for (int t = 0; t < T; t++) ts[t] = t;
+    for (uint64_t seed = 1; seed <= 20000; seed++) {
+        DecayingReservoir<int> d(1, alpha, 0, seed);
+        for (int t = 0; t < T; t++) d.Push(t, t);
+        hits[d[0] / 100]++;
+        DecayingReservoir<int> a(1, alpha, 0, seed * 2), b(1, alpha, 0, seed * 2 + 1);
+        for (int t = 0; t < T; t++) (t % 3 ? a : b).Push(t, t);
+        hitsMerged[(a + b)[0] / 100]++;
+    }
+    double total = 0, worst = 0, worstMerged = 0;
+    for (int t = 0; t < T; t++) total += std::exp(alpha * t);
+    for (int q = 0; q < 4; q++) {
+        double p = 0;
+        for (int t = q * 100; t < q * 100 + 100; t++) p += std::exp(alpha * t) / total;
+        worst = std::max(worst, std::fabs(hits[q] / 20000 - p));
+        worstMerged = std::max(worstMerged, std::fabs(hitsMerged[q] / 20000 - p));
+    }
+    std::cout << "decay quartile error " << worst << ", merged " << worstMerged << "\n";
+    check(worst < 0.015, "decaying reservoir weights by exp(alpha t)");
+    check(worstMerged < 0.015, "decaying reservoir merge keeps the weighting");
+
+    // large k: recent items dominate, and the batch path fills the sample
+    DecayingReservoir<int> recent(100, 0.001);
+    std::vector<int> xs(N);
+    std::vector<uint64_t> tn(N);
+    for (int i = 0; i < N; i++) xs[i] = i, tn[i] = i;
+    recent.Push(tn.data(), xs.data(), N);
+    double mean = 0;
+    recent.ForEach([&](int x) { mean += x; });
+    mean /= recent.Size();
+    std::cout << "decaying mean index " << mean << "\n";
+    check(recent.Size() == 100 && recent.Seen() == N && mean > 8000, "recent items favoured");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "RollingMedian.hpp"
+#include "check.h"
+
+static double brute(const std::vector<double> &x, size_t end, size_t w) {
+    size_t begin = end > w ? end - w : 0;
+    std::vector<double> v(x.begin() + begin, x.begin() + end);
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n & 1 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+int main() {
+    RollingMedian<double> m3(3);
+    for (double x : {5.0, 1.0, 3.0, 100.0, 2.0}) m3.Push(x);
+    std::cout << "Median: " << m3.Median() << "\n"; // median of 3, 100, 2 is 3
+    check(m3.Median() == 3.0, "window of 3");
+
+    uint32_t s = 42;
+    std::vector<double> x(3000);
+    for (auto &v : x) {
+        s = s * 1664525u + 1013904223u;
+        v = (s >> 20) % 50; // plenty of duplicates
+    }
+    for (size_t w : {1, 2, 5, 16, 17, 255}) {
+        RollingMedian<double> rm(w);
+        bool ok = true;
+        for (size_t i = 0; i < x.size(); i++) {
+            rm.Push(x[i]);
+            ok = ok && rm.Median() == brute(x, i + 1, w);
+        }
+        std::cout << "W=" << w << " ";
+        check(ok, "matches sort-based median");
+    }
+
+    RollingMedian<int> ri(4);
+    for (int v : {1, 9, 3, 7}) ri.Push(v);
+    check(ri.Median() == 5, "integer median of even window");
+
+    // spikes on a slow ramp are replaced, the ramp passes
+    HampelFilter<double> hf(15, 3.0);
+    int rejected = 0, wrong = 0;
+    for (int i = 0; i < 500; i++) {
+        double clean = 0.01 * i + 0.05 * std::sin(i);
+        bool spike = i > 50 && i % 37 == 0;
+        double y = hf.Push(spike ? clean + 20 : clean);
+        rejected += hf.Outlier();
+        if (i > 50 && std::fabs(y - clean) > 0.5) wrong++;
+    }
+    std::cout << "rejected " << rejected << "\n";
+    check(rejected == 12 && wrong == 0, "Hampel filter rejects spikes only");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,82 @@
+// runs the rstats tool on small generated files: test_rstats path/to/rstats
+#include <iostream>
+#include <cmath>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "check.h"
+
+// "key value" lines of one rstats run
+static std::map<std::string, double> run(const std::string &rstats, const std::string &args) {
+    std::map<std::string, double> out;
+    std::string cmd = rstats + " " + args + " 2>/dev/null";
+    FILE *p = popen(cmd.c_str(), "r");
+    if (p == NULL) return out;
+    char line[256], key[64];
+    double v;
+    while (fgets(line, sizeof(line), p)) {
+        if (sscanf(line, "%63s %lf", key, &v) == 2) out[key] = v;
+    }
+    out["exit"] = pclose(p);
+    return out;
+}
+
+static bool near(double a, double b, double tol) {
+    return std::fabs(a - b) <= tol;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "usage: test_rstats path/to/rstats\n";
+        return 1;
+    }
+    std::string rstats = argv[1];
+
+    // y = 3 + 0.5 * row, with a header and a blank line to skip
+    FILE *f = fopen("test_rstats.csv", "w");
+    fprintf(f, "t,y\n");
+    for (int i = 0; i < 1000; i++) {
+        fprintf(f, "%d,%g\n", 10 * i, 3 + 0.5 * i);
+        if (i == 500) fprintf(f, "\n");
+    }
+    fclose(f);
+
+    for (const char *threads : {"1", "4"}) {
+        std::map<std::string, double> r = run(rstats, std::string("-j ") + threads + " -c 1 test_rstats.csv");
+        std::cout << threads << " threads: ";
+        check(r["exit"] == 0 && r["rows"] == 1000, "csv rows, header skipped");
+        std::cout << threads << " threads: ";
+        check(near(r["mean"], 252.75, 1e-9) && r["min"] == 3 && r["max"] == 502.5, "csv mean, min, max");
+        std::cout << threads << " threads: ";
+        check(near(r["slope"], 0.5, 1e-12) && near(r["intercept"], 3, 1e-9) && near(r["correlation"], 1, 1e-12),
+              "regression on the row index across chunks");
+        std::cout << threads << " threads: ";
+        check(near(r["q0.5"], 252.75, 0.5) && near(r["q0.99"], 497.5, 0.5), "histogram quantiles within a sample spacing");
+    }
+
+    std::map<std::string, double> x = run(rstats, "-j 3 -x 0 -c 1 -q none test_rstats.csv");
+    check(near(x["slope"], 0.05, 1e-12) && near(x["intercept"], 3, 1e-9) && x.count("q0.5") == 0,
+          "regression on a column, no quantiles");
+
+    std::map<std::string, double> b = run(rstats, "-j 4 -b 64 -c 1 test_rstats.csv");
+    check(near(b["q0.5"], 252.75, 2.0) && near(b["slope"], 0.5, 1e-12), "streaming histogram quantiles in one pass");
+
+    // float64 records of 2 values
+    f = fopen("test_rstats.f64", "wb");
+    for (int i = 0; i < 4096; i++) {
+        double rec[2] = {double(i), i % 2 ? 1.0 : -1.0};
+        fwrite(rec, sizeof(rec), 1, f);
+    }
+    fclose(f);
+    std::map<std::string, double> d = run(rstats, "-j 4 -n 2 -c 1 test_rstats.f64");
+    check(d["rows"] == 4096 && near(d["mean"], 0, 1e-12) && near(d["variance"], 4096.0 / 4095, 1e-12),
+          "f64 records, second value");
+    check(near(d["slope"], 0, 1e-6) && d["min"] == -1 && d["max"] == 1, "f64 regression and range");
+
+    check(run(rstats, "-t xyz test_rstats.csv")["exit"] != 0, "bad option fails");
+
+    remove("test_rstats.csv");
+    remove("test_rstats.f64");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <cmath>
+#include "CachedStats.hpp"
+#include "RunningStats.hpp"
+#include "check.h"
+
+static bool close(_float_t a, _float_t b) {
+    return std::fabs(a - b) <= 1e-5 * (1 + std::fabs(b));
+}
+
+int main() {
+    RunningStats rs;
+    for (int i = 0; i < 1000; i++) rs.Push(_float_t(std::sin(0.37 * i) + 0.001 * i));
+
+    const RunningStats &crs = rs;
+    RunningStatsSummary s = crs.Summary();
+    check(s.n == rs.NumDataValues() && close(s.mean, rs.Mean()) && close(s.variance, rs.Variance()) &&
+          close(s.stddev, rs.StandardDeviation()) && close(s.skewness, rs.Skewness()) &&
+          close(s.kurtosis, rs.Kurtosis()), "summary matches the single accessors");
+    check(close(s.ci[CI90], crs.ConfidenceInterval(CI90)) && close(s.ci[CI95], crs.ConfidenceInterval(CI95)) &&
+          close(s.ci[CI99], crs.ConfidenceInterval(CI99)), "summary confidence intervals");
+
+    // Shift() moves the mean only
+    RunningStats shifted = rs;
+    shifted.Shift(10);
+    check(close(shifted.Mean(), rs.Mean() + 10) && close(shifted.Variance(), rs.Variance()) &&
+          close(shifted.Skewness(), rs.Skewness()), "shift moves the mean only");
+
+    // cached until the next change, generation moves by one with every change
+    CachedStats cs;
+    check(cs.Generation() == 0, "generation starts at 0");
+    for (int i = 0; i < 1000; i++) cs.Push(_float_t(std::sin(0.37 * i) + 0.001 * i));
+    check(cs.Generation() == 1000, "one generation per push");
+    const RunningStatsSummary &cached = cs.Summary();
+    check(close(cached.mean, s.mean) && close(cached.kurtosis, s.kurtosis), "cached summary matches");
+    _float_t mean = cached.mean;
+    check(&cs.Summary() == &cached && cs.Generation() == 1000, "summary cached while unchanged");
+    cs.Push(100);
+    check(cs.Generation() == 1001 && cs.Summary().n == 1001 && cs.Summary().mean > mean, "push invalidates the summary");
+
+    RunningStats other;
+    other.Push(1);
+    other.Push(2);
+    cs += other;
+    check(cs.Generation() == 1002 && cs.Summary().n == 1003, "merge invalidates the summary");
+    cs.Clear();
+    check(cs.Generation() == 1003 && cs.Summary().n == 0, "clear invalidates the summary");
+
+    // an aggregator re-merges a shard only when its generation moved
+    CachedStats shards[3];
+    RunningStats total;
+    uint64_t seen[3] = {0, 0, 0};
+    int merges = 0;
+    auto aggregate = [&]() {
+        bool changed = false;
+        for (int i = 0; i < 3; i++) changed = changed || shards[i].Generation() != seen[i];
+        if (!changed) return;
+        total.Clear();
+        for (int i = 0; i < 3; i++) {
+            total += shards[i].Stats();
+            seen[i] = shards[i].Generation();
+        }
+        merges++;
+    };
+    for (int i = 0; i < 3; i++) shards[i].Push(_float_t(i));
+    aggregate();
+    aggregate();
+    shards[1].Push(5);
+    aggregate();
+    check(merges == 2 && total.NumDataValues() == 4, "unchanged shards skipped");
+
+    // a shard cleared and refilled to the same count still shows as changed
+    uint64_t g = shards[0].Generation();
+    shards[0].Clear();
+    shards[0].Push(7);
+    check(shards[0].Generation() > g, "generation never repeats");
+
+    return failures ? 1 : 0;
+}
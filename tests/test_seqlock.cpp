@@ -0,0 +1,60 @@
+#include <iostream>
+#include <cmath>
+#include <thread>
+#include "SeqlockStats.hpp"
+#include "RunningStats.hpp"
+#include "RunningRegression.hpp"
+#include "check.h"
+
+// wide state so a torn copy is easy to spot: all fields derive from one counter
+struct Wide {
+    uint64_t v[8];
+    Wide() { Clear(); }
+    void Clear() { for (auto &x : v) x = 0; }
+    void Push(uint64_t x) { for (int i = 0; i < 8; i++) v[i] = x * (i + 1); }
+    bool Consistent() const {
+        for (int i = 0; i < 8; i++) if (v[i] != v[0] * (i + 1)) return false;
+        return true;
+    }
+};
+
+int main() {
+    SeqlockStats<RunningStats> rs;
+    for (int i = 1; i <= 5; i++) rs.Push(i);
+    RunningStats s = rs.Snapshot();
+    check(s.NumDataValues() == 5 && std::fabs(s.Mean() - 3.0) < 1e-6 &&
+          std::fabs(s.Variance() - 2.5) < 1e-5, "RunningStats snapshot");
+    rs.Modify([](RunningStats &r) { r.Clear(); });
+    check(rs.Snapshot().NumDataValues() == 0 && rs.Generation() == 6, "Modify publishes Clear");
+
+    SeqlockStats<RunningRegression> rr;
+    for (int i = 0; i < 10; i++) rr.Push(i, 2 * i + 1);
+    RunningRegression r = rr.Snapshot();
+    check(std::fabs(r.Slope() - 2.0) < 1e-4 && std::fabs(r.Intercept() - 1.0) < 1e-4, "RunningRegression snapshot");
+
+    SeqlockStats<RollingVariance<double>> rv(5);
+    for (int i = -2; i <= 2; i++) rv.Push(i);
+    auto v = rv.Snapshot();
+    check(std::fabs(v.Mean()) < 1e-12 && std::fabs(v.Variance() - 2.0) < 1e-12, "RollingVariance snapshot");
+
+    // concurrent writer and reader, no snapshot may be torn
+    SeqlockStats<Wide> wide;
+    const uint64_t N = 2000000;
+    uint64_t reads = 0, torn = 0, last = 0, backwards = 0;
+    std::thread writer([&] {
+        for (uint64_t i = 1; i <= N; i++) wide.Push(i);
+    });
+    for (;;) {
+        Wide w = wide.Snapshot();
+        reads++;
+        if (!w.Consistent()) torn++;
+        if (w.v[0] < last) backwards++;
+        last = w.v[0];
+        if (last == N) break;
+    }
+    writer.join();
+    std::cout << reads << " concurrent reads\n";
+    check(torn == 0 && backwards == 0, "no torn or stale snapshots under concurrent Push");
+
+    return failures ? 1 : 0;
+}
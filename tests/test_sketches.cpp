@@ -0,0 +1,114 @@
+#include <iostream>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+#include "HyperLogLog.hpp"
+#include "SpaceSaving.hpp"
+#include "check.h"
+
+// zipf-like key stream: key i has weight ~ 1 / (i + 1)^1.2
+static std::vector<uint64_t> zipf(size_t n, size_t keys, uint32_t seed) {
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (size_t i = 0; i < keys; i++) {
+        sum += 1.0 / std::pow(double(i + 1), 1.2);
+        cdf[i] = sum;
+    }
+    std::vector<uint64_t> out(n);
+    uint32_t s = seed;
+    for (auto &k : out) {
+        s = s * 1664525u + 1013904223u;
+        double u = (s >> 8) / double(1 << 24) * sum;
+        k = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+    }
+    return out;
+}
+
+int main() {
+    // error within 4 standard errors at every cardinality, RMS close to 1.04/sqrt(m)
+    HyperLogLog hll(12);
+    bool within = true;
+    double se = hll.StandardError(), sq = 0;
+    int trials = 0;
+    for (uint64_t seed = 1; seed <= 8; seed++) {
+        hll.Clear();
+        uint64_t n = 0;
+        for (uint64_t target : {10, 100, 1000, 10000, 100000, 1000000}) {
+            for (; n < target; n++) hll.Push(seed << 40 | n);
+            double err = hll.Estimate() / double(n) - 1;
+            within = within && std::fabs(err) < (n <= 100 ? 0.05 : 4 * se);
+            if (n >= 10000) {
+                sq += err * err;
+                trials++;
+            }
+        }
+    }
+    double rms = std::sqrt(sq / trials);
+    std::cout << "HLL p=12 rms error " << rms << ", standard error " << se << "\n";
+    check(within, "HLL estimate within bounds from 10 to 1e6 keys");
+    check(rms < 1.5 * se, "HLL rms error near the standard error");
+
+    HyperLogLog empty;
+    check(empty.Estimate() == 0, "HLL empty");
+
+    // union: merged sketch equals the sketch of the union, also across precisions
+    HyperLogLog a(14), b(14), u(14), b10(10), u10(10);
+    std::vector<uint64_t> hashes;
+    for (uint64_t i = 0; i < 50000; i++) {
+        uint64_t h = HashMix64(i);
+        (i < 30000 ? a : b).PushHashed(h);
+        if (i >= 20000) b10.PushHashed(h);
+        u.PushHashed(h);
+        u10.PushHashed(h);
+        hashes.push_back(h);
+    }
+    check((a + b).Estimate() == u.Estimate(), "HLL operator+ is the union");
+    HyperLogLog m = a + b10;
+    HyperLogLog m2 = a;
+    m2 += b10;
+    check(m.Precision() == 10 && m.Estimate() == u10.Estimate() && m2.Precision() == 10 &&
+          m2.Estimate() == u10.Estimate(), "HLL merge folds to the smaller precision");
+    HyperLogLog batch(14);
+    batch.PushHashed(hashes.data(), hashes.size());
+    check(batch.Estimate() == u.Estimate(), "HLL batch push");
+
+    // Space-Saving bounds against exact counts
+    const size_t K = 100;
+    std::vector<uint64_t> stream = zipf(200000, 50000, 3);
+    std::map<uint64_t, uint64_t> exact;
+    SpaceSaving<uint64_t> ss(K), s1(K), s2(K);
+    for (size_t i = 0; i < stream.size(); i++) {
+        exact[stream[i]]++;
+        ss.Push(stream[i]);
+        (i < stream.size() / 3 ? s1 : s2).Push(stream[i]);
+    }
+
+    auto bounded = [&](const SpaceSaving<uint64_t> &s) {
+        bool ok = s.Size() == K && s.Total() == stream.size();
+        for (const auto &e : s.Top()) {
+            uint64_t t = exact[e.key];
+            ok = ok && e.count >= t && e.count - e.error <= t;
+        }
+        for (const auto &kv : exact) {
+            if (kv.second > stream.size() / K) ok = ok && s.Count(kv.first) >= kv.second;
+            if (s.Count(kv.first) == 0) ok = ok && kv.second <= s.MinCount();
+        }
+        return ok;
+    };
+    check(bounded(ss), "Space-Saving count bounds and frequent keys monitored");
+    auto top = ss.Top();
+    bool order = true;
+    for (size_t i = 0; i < 10; i++) order = order && top[i].key == i;
+    check(order, "Space-Saving top 10 in order");
+    SpaceSaving<uint64_t> merged = s1 + s2;
+    check(bounded(merged), "Space-Saving merge keeps the bounds");
+
+    // string keys, not yet full: counts are exact
+    SpaceSaving<std::string> words(8);
+    for (const char *w : {"get", "put", "get", "del", "get", "put"}) words.Push(w);
+    check(words.Count("get") == 3 && words.Count("put") == 2 && words.Error("get") == 0 &&
+          words.Count("head") == 0 && words.Top()[0].key == "get", "Space-Saving string keys");
+
+    return failures ? 1 : 0;
+}
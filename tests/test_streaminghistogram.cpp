@@ -0,0 +1,129 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "StreamingHistogram.hpp"
+#include "check.h"
+
+// largest rank error of the histogram's quantiles against the sorted data
+static double rankError(const StreamingHistogram<double> &h, std::vector<double> sorted) {
+    std::sort(sorted.begin(), sorted.end());
+    double worst = 0;
+    for (double q = 0.01; q < 1; q += 0.01) {
+        double v = h.Quantile(q);
+        double rank = double(std::upper_bound(sorted.begin(), sorted.end(), v) - sorted.begin()) / sorted.size();
+        worst = std::max(worst, std::fabs(rank - q));
+        double cdf = h.CDF(sorted[size_t(q * sorted.size())]);
+        worst = std::max(worst, std::fabs(cdf - q));
+    }
+    return worst;
+}
+
+static bool consistent(const StreamingHistogram<double> &h) {
+    uint64_t total = 0;
+    bool sorted = true;
+    for (size_t i = 0; i < h.Bins(); i++) {
+        total += h.BinCount(i);
+        if (i) sorted = sorted && h.Centroid(i - 1) < h.Centroid(i);
+    }
+    return sorted && total == h.Count() && h.Bins() <= h.Capacity();
+}
+
+int main() {
+    // skewed data: lognormal via Box-Muller
+    uint32_t s = 11;
+    auto uniform = [&]() {
+        s = s * 1664525u + 1013904223u;
+        return ((s >> 8) + 0.5) / double(1 << 24);
+    };
+    std::vector<double> x(100000);
+    for (auto &v : x) v = std::exp(0.5 * std::sqrt(-2 * std::log(uniform())) * std::cos(6.283185307 * uniform()));
+
+    StreamingHistogram<double> single(64), batch(64);
+    for (double v : x) single.Push(v);
+    batch.Push(x.data(), x.size());
+    double es = rankError(single, x), eb = rankError(batch, x);
+    std::cout << "rank error: single " << es << ", batch " << eb << "\n";
+    check(consistent(single) && consistent(batch) && single.Count() == x.size() && batch.Count() == x.size(),
+          "bins sorted, counts add up");
+    check(es < 0.01, "quantiles and CDF within 1% rank, single pushes");
+    check(eb < 0.01, "quantiles and CDF within 1% rank, batch pushes");
+    check(single.Min() == *std::min_element(x.begin(), x.end()) && single.Quantile(0) == single.Min() &&
+          single.Quantile(1) == single.Max() && single.CDF(single.Max()) == 1, "exact extremes");
+
+    // merge of shards with different ranges
+    std::vector<double> y(x);
+    for (size_t i = 0; i < y.size() / 2; i++) y[i] += 3;
+    StreamingHistogram<double> a(64), b(64);
+    a.Push(y.data(), y.size() / 2);
+    b.Push(y.data() + y.size() / 2, y.size() - y.size() / 2);
+    StreamingHistogram<double> m = a + b;
+    double em = rankError(m, y);
+    std::cout << "rank error merged " << em << "\n";
+    check(consistent(m) && m.Count() == y.size() && em < 0.015, "merge");
+
+    // fewer distinct values than bins: exact
+    StreamingHistogram<double> few(16);
+    std::vector<double> dice;
+    for (int i = 0; i < 600; i++) dice.push_back(1 + i % 6);
+    few.Push(dice.data(), 300);
+    for (int i = 300; i < 600; i++) few.Push(dice[i]);
+    bool exact = few.Bins() == 6;
+    for (size_t i = 0; i < few.Bins(); i++) exact = exact && few.Centroid(i) == i + 1 && few.BinCount(i) == 100;
+    check(exact, "distinct values keep their own bins");
+
+    // single pushes after a batch, a merge and a Clear, which rebuild the gap
+    // tree, and on a grid where most gaps are equal
+    StreamingHistogram<double> mixed(256);
+    std::vector<double> part(x.begin(), x.begin() + 60000);
+    mixed.Push(part.data(), 20000);
+    for (size_t i = 20000; i < 40000; i++) mixed.Push(part[i]);
+    StreamingHistogram<double> rest(256);
+    rest.Push(part.data() + 40000, 10000);
+    mixed += rest;
+    for (size_t i = 50000; i < 60000; i++) mixed.Push(part[i]);
+    double ex = rankError(mixed, part);
+    std::cout << "rank error mixed " << ex << "\n";
+    check(consistent(mixed) && mixed.Count() == part.size() && ex < 0.005, "single pushes after batches and merges");
+    mixed.Clear();
+    std::vector<double> grid;
+    for (int i = 0; i < 20000; i++) grid.push_back(double(i * 7919 % 1000));
+    for (double v : grid) mixed.Push(v);
+    double eg = rankError(mixed, grid);
+    std::cout << "rank error grid " << eg << "\n";
+    check(consistent(mixed) && mixed.Bins() == 256 && eg < 0.005, "equal gaps");
+
+    // gaps far beyond the float range: the same bins as merging the closest
+    // pair by a scan, with Merged()'s arithmetic
+    for (size_t bins : {2, 8, 64}) {
+        StreamingHistogram<double> wide(bins);
+        std::vector<double> c, m;
+        for (int i = 0; i < 2000; i++) {
+            double v = (2 * uniform() - 1) * 1e300;
+            wide.Push(v);
+            size_t j = std::lower_bound(c.begin(), c.end(), v) - c.begin();
+            c.insert(c.begin() + j, v);
+            m.insert(m.begin() + j, 1);
+            if (c.size() > bins) {
+                size_t best = 0;
+                for (size_t k = 1; k + 1 < c.size(); k++) best = c[k + 1] - c[k] < c[best + 1] - c[best] ? k : best;
+                double merged = c[best] + (c[best + 1] - c[best]) * (m[best + 1] / (m[best] + m[best + 1]));
+                c[best] = merged < c[best + 1] ? merged : c[best + 1];
+                m[best] += m[best + 1];
+                c.erase(c.begin() + best + 1);
+                m.erase(m.begin() + best + 1);
+            }
+        }
+        bool same = consistent(wide) && wide.Bins() == c.size();
+        for (size_t i = 0; same && i < c.size(); i++) same = wide.Centroid(i) == c[i] && wide.BinCount(i) == m[i];
+        std::cout << bins << " bins: ";
+        check(same, "closest pairs merged across a +-1e300 range");
+    }
+
+    StreamingHistogram<double> one(8), empty(8);
+    one.Push(2.5);
+    check(one.Quantile(0.5) == 2.5 && one.CDF(2) == 0 && one.CDF(2.5) == 1, "single sample");
+    check(std::isnan(empty.Quantile(0.5)) && std::isnan(empty.CDF(0)), "empty histogram");
+
+    return failures ? 1 : 0;
+}
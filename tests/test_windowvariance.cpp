@@ -1,32 +1,33 @@
 #include <iostream>
+#include <cmath>
 #include "WindowVariance.hpp"
+#include "check.h"
+
+static bool close(float a, float b) {
+    return std::fabs(a - b) <= 1e-5f * (1 + std::fabs(b));
+}
 
 int main() {
     WindowVariance<float> winvar(3);
-    
-    // Adding elements
+    check(winvar.getWindowSize() == 3, "window size");
+
     winvar.Add(1);
     winvar.Add(2);
     winvar.Add(3);
-    
-    // iterate
-    for (float val : *winvar.cb) {
-        std::cout << val << "\n";  // Prints 5 6
-    }
-    std::cout <<  "add 4\n";  // Prints 5 6
+    std::cout << "Variance:" << winvar.Variance() << " Mean:" << winvar.Mean() << "\n";
+    check(close(winvar.Variance(), 1) && close(winvar.Mean(), 2), "window 1 2 3");
 
+    // 1 leaves the window
     winvar.Add(4);
-
-    for (float val : *winvar.cb) {
-        std::cout << val << "\n";  // Prints 5 6
-    }
-    
-    std::cout << "Variance:" << winvar.Variance() << "\n";  
-    std::cout << "Mean:" << winvar.Mean() << "\n";  
+    float sum = 0;
+    for (float val : *winvar.cb) sum += val;
+    check(sum == 9, "window holds 2 3 4");
+    std::cout << "Variance:" << winvar.Variance() << " Mean:" << winvar.Mean() << "\n";
+    check(close(winvar.Variance(), 1) && close(winvar.Mean(), 3), "window 2 3 4");
 
     winvar.Add(7);
-    std::cout << "Variance:" << winvar.Variance() << "\n";  
-    std::cout << "Mean:" << winvar.Mean() << "\n";  
+    std::cout << "Variance:" << winvar.Variance() << " Mean:" << winvar.Mean() << "\n";
+    check(close(winvar.Variance(), 13.0f / 3) && close(winvar.Mean(), 14.0f / 3), "window 3 4 7 (n-1 denominator)");
 
-    return 0;
-}
\ No newline at end of file
+    return failures ? 1 : 0;
+}
@@ -39,6 +39,9 @@
 #include <vector>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
 
 #define _float_t double
 
@@ -149,9 +152,9 @@ void runTest(const std::vector<double>& data, double expected, const std::string
     //     }
     // }
 
-    RollingVariance ov(WINDOW);
-    for (double x : data) ov.add(x);
-    result = ov.variance();
+    RollingVariance<double> ov(WINDOW);
+    for (double x : data) ov.Push(x);
+    result = ov.Variance();
     std::cout << "Test ov: " << testName << " - ";
     if (data.empty()) {
         if (std::isnan(result) && std::isnan(expected)) {
@@ -198,7 +201,7 @@ int main() {
     runTest({3, 3, 3, 3}, 0.0, "All Identical");
     runTest({1, 2, 3, 4, 5}, 2.0, "Small Positive Integers");
     runTest({-2, -1, 0, 1, 2}, 2.0, "Negative Numbers");
-    runTest({1, 1000, 1000000}, 332332333.333333, "Large Range");
+    runTest({1, 1000, 1000000}, 221999999778.0, "Large Range"); // population variance, was 332332333.33
     runTest({1.5, 2.5, 3.5}, 0.666667, "Floating-Point");
     runTest({2, 2, 4, 4}, 1.0, "Duplicates");
 
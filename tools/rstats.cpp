@@ -0,0 +1,362 @@
+// rstats - moments, quantiles and a regression fit of one column of a large
+// file, at memory bandwidth
+//
+//   rstats [options] file
+//     -t f32|f64|csv   input type, default from the file name (.f32 .f64 .csv)
+//     -n columns       binary: values per record (default 1)
+//     -c column        column of the values, 0-based (default 0)
+//     -x column        regress on this column instead of the row index
+//     -d delimiter     csv: field delimiter (default ,)
+//     -q p,p,...       quantiles (default 0.01,0.25,0.5,0.75,0.99), "none" to skip
+//     -b bins          quantiles from a StreamingHistogram of that many bins
+//     -j threads       default: all cores
+//
+// the file is memory-mapped and split into one chunk per thread (csv chunks
+// end on line breaks). Each thread accumulates RunningStats and
+// RunningRegression for its chunk in one pass, numbering rows from 0; once
+// the row counts of all chunks are known each regression is shifted to its
+// first row and the results are reduced with operator+.
+// Quantiles take a second pass: a 65536 bin histogram between min and max,
+// so they are accurate to (max - min) / 65536. With -b they come from
+// per-thread StreamingHistograms filled in the first pass instead, which
+// adapt their bins to the data (better with far outliers), and the file is
+// read once. csv lines whose fields do not parse (e.g. a header) are counted
+// and skipped.
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "RunningRegression.hpp"
+#include "RunningStats.hpp"
+#include "StreamingHistogram.hpp"
+
+#define HIST_BINS 65536
+#define BLOCK 4096 // values per StreamingHistogram batch
+
+enum input_t { IN_F32, IN_F64, IN_CSV };
+
+struct Options {
+    input_t type = IN_CSV;
+    bool typeSet = false;
+    size_t columns = 1;
+    size_t column = 0;
+    long xcolumn = -1;
+    char delim = ',';
+    std::vector<double> quantiles = {0.01, 0.25, 0.5, 0.75, 0.99};
+    unsigned threads = 0;
+    size_t bins = 0;
+};
+
+struct Chunk {
+    const char *begin, *end;
+    uint64_t rows, skipped;
+    double min, max;
+    RunningStats stats;
+    RunningRegression reg;
+    std::vector<uint64_t> hist;
+    StreamingHistogram<double> sh{2};
+};
+
+static double now_s(void) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// one field as double: from_chars does not allocate and rounds correctly,
+// it only needs leading blanks and a '+' taken off
+static bool parse_field(const char *p, const char *e, double &v) {
+    while (p < e && (*p == ' ' || *p == '\t')) p++;
+    if (p < e && *p == '+') p++;
+    auto r = std::from_chars(p, e, v);
+    if (r.ec != std::errc()) return false;
+    for (p = r.ptr; p < e; p++) {
+        if (*p != ' ' && *p != '\t' && *p != '\r') return false;
+    }
+    return true;
+}
+
+// call fn(x, y) for every record of the chunk, x being the regressor: a
+// column, or the row index within the chunk
+template <typename Fn>
+static void scan(const Options &o, Chunk &c, Fn fn) {
+    uint64_t row = 0;
+    if (o.type != IN_CSV) {
+        size_t width = o.type == IN_F32 ? sizeof(float) : sizeof(double);
+        size_t record = width * o.columns;
+        for (const char *p = c.begin; p + record <= c.end; p += record, row++) {
+            double x, y;
+            if (o.type == IN_F32) {
+                float fx, fy;
+                memcpy(&fy, p + o.column * width, sizeof(float));
+                memcpy(&fx, p + (o.xcolumn < 0 ? 0 : o.xcolumn) * width, sizeof(float));
+                x = fx;
+                y = fy;
+            } else {
+                memcpy(&y, p + o.column * width, sizeof(double));
+                memcpy(&x, p + (o.xcolumn < 0 ? 0 : o.xcolumn) * width, sizeof(double));
+            }
+            fn(o.xcolumn < 0 ? double(row) : x, y);
+        }
+        return;
+    }
+    size_t last = std::max<size_t>(o.column, o.xcolumn < 0 ? 0 : o.xcolumn);
+    for (const char *p = c.begin; p < c.end;) {
+        const char *eol = (const char *)memchr(p, '\n', c.end - p);
+        if (eol == NULL) eol = c.end;
+        const char *fb = p, *fy = NULL, *fye = NULL, *fx = NULL, *fxe = NULL;
+        size_t field = 0;
+        for (const char *q = p; field <= last; q++) {
+            if (q == eol || *q == o.delim) {
+                if (field == o.column) { fy = fb; fye = q; }
+                if ((long)field == o.xcolumn) { fx = fb; fxe = q; }
+                field++;
+                fb = q + 1;
+                if (q == eol) break;
+            }
+        }
+        double x = double(row), y;
+        if (fy && parse_field(fy, fye, y) && (o.xcolumn < 0 || (fx && parse_field(fx, fxe, x)))) {
+            fn(x, y);
+            row++;
+        } else if (eol > p && !(eol == p + 1 && *p == '\r')) {
+            c.skipped++;
+        }
+        p = eol + 1;
+    }
+}
+
+// split [base, base + size) into chunks of whole records or whole lines
+static std::vector<Chunk> split(const Options &o, const char *base, size_t size, unsigned n) {
+    std::vector<Chunk> chunks(n);
+    size_t record = o.type == IN_CSV ? 1 : (o.type == IN_F32 ? 4 : 8) * o.columns;
+    size_t records = size / record;
+    const char *p = base, *end = base + records * record;
+    for (unsigned i = 0; i < n; i++) {
+        const char *e = i + 1 == n ? end : base + records * (i + 1) / n * record;
+        if (o.type == IN_CSV && e < end) {
+            const char *nl = (const char *)memchr(e, '\n', end - e);
+            e = nl ? nl + 1 : end;
+        }
+        if (e < p) e = p;
+        chunks[i].begin = p;
+        chunks[i].end = e;
+        chunks[i].rows = chunks[i].skipped = 0;
+        chunks[i].min = INFINITY;
+        chunks[i].max = -INFINITY;
+        p = e;
+    }
+    return chunks;
+}
+
+template <typename Fn>
+static void parallel(std::vector<Chunk> &chunks, Fn fn) {
+    std::vector<std::thread> pool;
+    for (auto &c : chunks) {
+        pool.emplace_back([&fn, &c] { fn(c); });
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+}
+
+static int usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-t f32|f64|csv] [-n columns] [-c column] [-x column] [-d delimiter]\n"
+                    "       [-q p,p,...|none] [-b bins] [-j threads] file\n", prog);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    Options o;
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (a[0] != '-' || a[1] == 0) {
+            path = a;
+            continue;
+        }
+        if (i + 1 >= argc) return usage(argv[0]);
+        const char *v = argv[++i];
+        switch (a[1]) {
+        case 't':
+            o.typeSet = true;
+            if (!strcmp(v, "f32")) o.type = IN_F32;
+            else if (!strcmp(v, "f64")) o.type = IN_F64;
+            else if (!strcmp(v, "csv")) o.type = IN_CSV;
+            else return usage(argv[0]);
+            break;
+        case 'n': o.columns = strtoul(v, NULL, 0); break;
+        case 'c': o.column = strtoul(v, NULL, 0); break;
+        case 'x': o.xcolumn = strtol(v, NULL, 0); break;
+        case 'd': o.delim = v[0] == '\\' && v[1] == 't' ? '\t' : v[0]; break;
+        case 'j': o.threads = strtoul(v, NULL, 0); break;
+        case 'b': o.bins = strtoul(v, NULL, 0); break;
+        case 'q':
+            o.quantiles.clear();
+            for (char *p = (char *)v; strcmp(v, "none") && *p;) {
+                o.quantiles.push_back(strtod(p, &p));
+                if (*p == ',') p++;
+                else if (*p) return usage(argv[0]);
+            }
+            break;
+        default: return usage(argv[0]);
+        }
+    }
+    if (path == NULL || o.columns == 0) {
+        return usage(argv[0]);
+    }
+    if (!o.typeSet) {
+        const char *dot = strrchr(path, '.');
+        o.type = dot && !strcmp(dot, ".f32") ? IN_F32 : dot && !strcmp(dot, ".f64") ? IN_F64 : IN_CSV;
+    }
+    if (o.type != IN_CSV && (o.column >= o.columns || o.xcolumn >= (long)o.columns)) {
+        return usage(argv[0]);
+    }
+
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(path);
+        return 1;
+    }
+    size_t size = st.st_size;
+    const char *base = NULL;
+    if (size) {
+        base = (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            perror("mmap");
+            return 1;
+        }
+        madvise((void *)base, size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    unsigned n = o.threads ? o.threads : std::max(1u, std::thread::hardware_concurrency());
+    double t0 = now_s();
+
+    // pass 1: moments, regression, range and row counts per chunk
+    std::vector<Chunk> chunks = split(o, base, size, n);
+    bool streaming = o.bins > 0 && !o.quantiles.empty();
+    parallel(chunks, [&](Chunk &c) {
+        std::vector<double> block;
+        if (streaming) {
+            c.sh = StreamingHistogram<double>(o.bins);
+            block.reserve(BLOCK);
+        }
+        scan(o, c, [&](double x, double y) {
+            c.stats.Push(y);
+            c.reg.Push(x, y);
+            c.min = std::min(c.min, y);
+            c.max = std::max(c.max, y);
+            if (streaming) {
+                block.push_back(y);
+                if (block.size() == BLOCK) {
+                    c.sh.Push(block.data(), block.size());
+                    block.clear();
+                }
+            }
+        });
+        if (streaming) {
+            c.sh.Push(block.data(), block.size());
+        }
+        c.rows = c.stats.NumDataValues();
+    });
+    RunningStats stats;
+    RunningRegression reg;
+    StreamingHistogram<double> sh(streaming ? o.bins : 2);
+    double lo = INFINITY, hi = -INFINITY;
+    uint64_t skipped = 0, row = 0;
+    for (auto &c : chunks) {
+        stats += c.stats;
+        if (o.xcolumn < 0) {
+            c.reg.ShiftX(double(row)); // the chunk's first row, now known
+        }
+        reg += c.reg;
+        if (streaming) {
+            sh += c.sh;
+        }
+        lo = std::min(lo, c.min);
+        hi = std::max(hi, c.max);
+        skipped += c.skipped;
+        row += c.rows;
+    }
+    double t1 = now_s();
+
+    // pass 2, only for the fixed histogram
+    bool hist = !streaming && !o.quantiles.empty() && stats.NumDataValues() > 0;
+    double scale = hi > lo ? HIST_BINS / (hi - lo) : 0;
+    std::vector<uint64_t> counts(hist ? HIST_BINS : 0, 0);
+    uint64_t total = 0;
+    if (hist) {
+        parallel(chunks, [&](Chunk &c) {
+            c.hist.assign(HIST_BINS, 0);
+            scan(o, c, [&](double, double y) {
+                // NaN fails the test and is left out, inf ends up in an end bin
+                double pos = (y - lo) * scale;
+                if (pos >= 0) {
+                    c.hist[pos < HIST_BINS ? size_t(pos) : HIST_BINS - 1]++;
+                }
+            });
+        });
+        for (auto &c : chunks) {
+            for (size_t b = 0; b < HIST_BINS; b++) {
+                counts[b] += c.hist[b];
+                total += c.hist[b];
+            }
+        }
+    }
+    double t2 = now_s();
+
+    printf("file         %s\n", path);
+    printf("rows         %llu (skipped %llu)\n", (unsigned long long)stats.NumDataValues(), (unsigned long long)skipped);
+    printf("mean         %.17g\n", stats.Mean());
+    printf("stddev       %.17g\n", stats.StandardDeviation());
+    printf("variance     %.17g\n", stats.Variance());
+    printf("skewness     %.17g\n", stats.Skewness());
+    printf("kurtosis     %.17g\n", stats.Kurtosis());
+    printf("min          %.17g\n", lo);
+    printf("max          %.17g\n", hi);
+    if (hist && total > 0) {
+        // rank q * (n - 1), linear within the bin
+        double width = (hi - lo) / HIST_BINS;
+        for (double q : o.quantiles) {
+            double rank = std::min(std::max(q, 0.0), 1.0) * double(total - 1);
+            uint64_t below = 0;
+            size_t b = 0;
+            while (b + 1 < HIST_BINS && double(below + counts[b]) <= rank) {
+                below += counts[b++];
+            }
+            double v = counts[b] ? lo + width * (b + (rank - below + 0.5) / counts[b]) : lo + width * b;
+            printf("q%-11g %.9g\n", q, std::min(std::max(v, lo), hi));
+        }
+    }
+    if (streaming && stats.NumDataValues() > 0) {
+        for (double q : o.quantiles) {
+            printf("q%-11g %.9g\n", q, sh.Quantile(q));
+        }
+    }
+    printf("slope        %.17g\n", reg.Slope());
+    printf("intercept    %.17g\n", reg.Intercept());
+    printf("correlation  %.17g\n", reg.Correlation());
+    printf("regressor    %s\n", o.xcolumn < 0 ? "row index" : "column");
+    fprintf(stderr, "%.1f MB, %u threads, pass 1 %.3f s (%.0f MB/s)", size / 1e6, n, t1 - t0,
+            size / 1e6 / (t1 - t0));
+    if (hist) {
+        fprintf(stderr, ", pass 2 %.3f s (%.0f MB/s)", t2 - t1, size / 1e6 / (t2 - t1));
+    }
+    fprintf(stderr, "\n");
+
+    if (base) {
+        munmap((void *)base, size);
+    }
+    return 0;
+}